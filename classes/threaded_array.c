@@ -60,6 +60,16 @@ PHP_METHOD(ThreadedArray, chunk)
 	pthreads_store_chunk(Z_OBJ_P(getThis()), size, preserve, return_value);
 } /* }}} */
 
+/* {{{ proto ThreadedArray ThreadedArray::copy()
+	Will create a new ThreadedArray with the same members, sharing their storage until either is written */
+PHP_METHOD(ThreadedArray, copy)
+{
+	zend_parse_parameters_none_throw();
+
+	object_init_ex(return_value, pthreads_threaded_array_entry);
+	pthreads_store_merge(Z_OBJ_P(return_value), getThis(), 1, PTHREADS_STORE_COERCE_ARRAY);
+} /* }}} */
+
 /* {{{ proto mixed ThreadedArray::pop()
 	Will pop the last member from the object */
 PHP_METHOD(ThreadedArray, pop)
@@ -95,6 +105,20 @@ PHP_METHOD(ThreadedArray, fromArray)
 	pthreads_store_merge(Z_OBJ_P(return_value), input, 1, PTHREADS_STORE_COERCE_ARRAY);
 } /* }}} */
 
+/* {{{ proto array ThreadedArray::toArray([boolean $recursive = true])
+	Will copy all members to an array, converting nested ThreadedArrays to arrays if recursive */
+PHP_METHOD(ThreadedArray, toArray)
+{
+	zend_bool recursive = 1;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 0, 1)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_BOOL(recursive)
+	ZEND_PARSE_PARAMETERS_END();
+
+	pthreads_store_to_array(Z_OBJ_P(getThis()), return_value, recursive);
+} /* }}} */
+
 /* {{{ proto mixed ThreadedArray::offsetGet(mixed $offset)
 	Gets an offset from the array */
 PHP_METHOD(ThreadedArray, offsetGet)
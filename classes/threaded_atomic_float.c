@@ -0,0 +1,131 @@
+/*
+  +----------------------------------------------------------------------+
+  | pthreads                                                             |
+  +----------------------------------------------------------------------+
+  | Copyright (c) Joe Watkins 2012 - 2015                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Joe Watkins <krakjoe@php.net>                                |
+  +----------------------------------------------------------------------+
+ */
+
+#include <src/pthreads.h>
+#include <src/atomic.h>
+
+/* {{{ doubles are stored by their bit pattern */
+static zend_always_inline uint64_t pthreads_atomic_float_to_bits(double value) {
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static zend_always_inline double pthreads_atomic_float_from_bits(uint64_t bits) {
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+} /* }}} */
+
+/* {{{ proto ThreadedAtomicFloat::__construct([float $value = 0.0])
+	Creates an atomic float with the given initial value */
+PHP_METHOD(ThreadedAtomicFloat, __construct)
+{
+	double value = 0.0;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 0, 1)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_DOUBLE(value)
+	ZEND_PARSE_PARAMETERS_END();
+
+	pthreads_atomic_store_u64(PTHREADS_FETCH_ATOMIC, pthreads_atomic_float_to_bits(value));
+} /* }}} */
+
+/* {{{ proto float ThreadedAtomicFloat::get()
+	Will return the current value */
+PHP_METHOD(ThreadedAtomicFloat, get)
+{
+	zend_parse_parameters_none_throw();
+
+	RETURN_DOUBLE(pthreads_atomic_float_from_bits(pthreads_atomic_load_u64(PTHREADS_FETCH_ATOMIC)));
+} /* }}} */
+
+/* {{{ proto void ThreadedAtomicFloat::set(float $value)
+	Will set the value */
+PHP_METHOD(ThreadedAtomicFloat, set)
+{
+	double value;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 1, 1)
+		Z_PARAM_DOUBLE(value)
+	ZEND_PARSE_PARAMETERS_END();
+
+	pthreads_atomic_store_u64(PTHREADS_FETCH_ATOMIC, pthreads_atomic_float_to_bits(value));
+} /* }}} */
+
+/* {{{ proto float ThreadedAtomicFloat::add([float $delta = 1.0])
+	Will add delta to the value, returning the new value */
+PHP_METHOD(ThreadedAtomicFloat, add)
+{
+	double delta = 1.0, value;
+	volatile uint64_t *atomic = PTHREADS_FETCH_ATOMIC;
+	uint64_t current;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 0, 1)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_DOUBLE(delta)
+	ZEND_PARSE_PARAMETERS_END();
+
+	//there's no atomic floating point addition, so retry until nobody else changed the value in the meantime
+	current = pthreads_atomic_load_u64(atomic);
+	do {
+		value = pthreads_atomic_float_from_bits(current) + delta;
+	} while (!pthreads_atomic_compare_exchange_u64(atomic, &current, pthreads_atomic_float_to_bits(value)));
+
+	RETURN_DOUBLE(value);
+} /* }}} */
+
+/* {{{ proto float ThreadedAtomicFloat::swap(float $value)
+	Will set the value, returning the previous value */
+PHP_METHOD(ThreadedAtomicFloat, swap)
+{
+	double value;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 1, 1)
+		Z_PARAM_DOUBLE(value)
+	ZEND_PARSE_PARAMETERS_END();
+
+	RETURN_DOUBLE(pthreads_atomic_float_from_bits(
+		pthreads_atomic_exchange_u64(PTHREADS_FETCH_ATOMIC, pthreads_atomic_float_to_bits(value))
+	));
+} /* }}} */
+
+/* {{{ proto bool ThreadedAtomicFloat::compareExchange(float $expected, float $value)
+	Will set the value if the current value is equal to expected
+	Returns whether the value was set */
+PHP_METHOD(ThreadedAtomicFloat, compareExchange)
+{
+	double expected, value;
+	volatile uint64_t *atomic = PTHREADS_FETCH_ATOMIC;
+	uint64_t current;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 2, 2)
+		Z_PARAM_DOUBLE(expected)
+		Z_PARAM_DOUBLE(value)
+	ZEND_PARSE_PARAMETERS_END();
+
+	//values are compared as numbers rather than bitwise, so e.g. 0.0 and -0.0 are equal, and NaN never is
+	current = pthreads_atomic_load_u64(atomic);
+	while (pthreads_atomic_float_from_bits(current) == expected) {
+		if (pthreads_atomic_compare_exchange_u64(atomic, &current, pthreads_atomic_float_to_bits(value))) {
+			RETURN_TRUE;
+		}
+	}
+
+	RETURN_FALSE;
+} /* }}} */
@@ -0,0 +1,102 @@
+/*
+  +----------------------------------------------------------------------+
+  | pthreads                                                             |
+  +----------------------------------------------------------------------+
+  | Copyright (c) Joe Watkins 2012 - 2015                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Joe Watkins <krakjoe@php.net>                                |
+  +----------------------------------------------------------------------+
+ */
+
+#include <src/pthreads.h>
+#include <src/atomic.h>
+
+/* {{{ proto ThreadedAtomicInt::__construct([int $value = 0])
+	Creates an atomic integer with the given initial value */
+PHP_METHOD(ThreadedAtomicInt, __construct)
+{
+	zend_long value = 0;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 0, 1)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_LONG(value)
+	ZEND_PARSE_PARAMETERS_END();
+
+	pthreads_atomic_store_u64(PTHREADS_FETCH_ATOMIC, (uint64_t) (int64_t) value);
+} /* }}} */
+
+/* {{{ proto int ThreadedAtomicInt::get()
+	Will return the current value */
+PHP_METHOD(ThreadedAtomicInt, get)
+{
+	zend_parse_parameters_none_throw();
+
+	RETURN_LONG((zend_long) (int64_t) pthreads_atomic_load_u64(PTHREADS_FETCH_ATOMIC));
+} /* }}} */
+
+/* {{{ proto void ThreadedAtomicInt::set(int $value)
+	Will set the value */
+PHP_METHOD(ThreadedAtomicInt, set)
+{
+	zend_long value;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 1, 1)
+		Z_PARAM_LONG(value)
+	ZEND_PARSE_PARAMETERS_END();
+
+	pthreads_atomic_store_u64(PTHREADS_FETCH_ATOMIC, (uint64_t) (int64_t) value);
+} /* }}} */
+
+/* {{{ proto int ThreadedAtomicInt::add([int $delta = 1])
+	Will add delta to the value, returning the new value */
+PHP_METHOD(ThreadedAtomicInt, add)
+{
+	zend_long delta = 1;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 0, 1)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_LONG(delta)
+	ZEND_PARSE_PARAMETERS_END();
+
+	RETURN_LONG((zend_long) (int64_t) (
+		pthreads_atomic_fetch_add_u64(PTHREADS_FETCH_ATOMIC, (uint64_t) (int64_t) delta) + (uint64_t) (int64_t) delta
+	));
+} /* }}} */
+
+/* {{{ proto int ThreadedAtomicInt::swap(int $value)
+	Will set the value, returning the previous value */
+PHP_METHOD(ThreadedAtomicInt, swap)
+{
+	zend_long value;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 1, 1)
+		Z_PARAM_LONG(value)
+	ZEND_PARSE_PARAMETERS_END();
+
+	RETURN_LONG((zend_long) (int64_t) pthreads_atomic_exchange_u64(PTHREADS_FETCH_ATOMIC, (uint64_t) (int64_t) value));
+} /* }}} */
+
+/* {{{ proto bool ThreadedAtomicInt::compareExchange(int $expected, int $value)
+	Will set the value if the current value is equal to expected
+	Returns whether the value was set */
+PHP_METHOD(ThreadedAtomicInt, compareExchange)
+{
+	zend_long expected, value;
+	uint64_t current;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 2, 2)
+		Z_PARAM_LONG(expected)
+		Z_PARAM_LONG(value)
+	ZEND_PARSE_PARAMETERS_END();
+
+	current = (uint64_t) (int64_t) expected;
+	RETURN_BOOL(pthreads_atomic_compare_exchange_u64(PTHREADS_FETCH_ATOMIC, &current, (uint64_t) (int64_t) value));
+} /* }}} */
@@ -18,45 +18,88 @@
 
 #include <src/pthreads.h>
 
-/* {{{ proto boolean ThreadedBase::wait([long timeout])
+/* {{{ proto boolean ThreadedBase::wait([long timeout [, ?string key]])
 		Will cause the calling thread to wait for notification from the referenced object
+		If a key is given, only notifications for the same key will end the wait
 		When a timeout is used and reached boolean false will return
 		Otherwise returns a boolean indication of success */
 PHP_METHOD(ThreadedBase, wait)
 {
 	pthreads_object_t* threaded = PTHREADS_FETCH_TS;
 	zend_long timeout = 0L;
+	zend_string *key = NULL;
 
-	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 0, 1)
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 0, 2)
 		Z_PARAM_OPTIONAL
 		Z_PARAM_LONG(timeout)
+		Z_PARAM_STR_OR_NULL(key)
 	ZEND_PARSE_PARAMETERS_END();
-	
-	RETURN_BOOL(pthreads_monitor_wait(&threaded->monitor, timeout) == SUCCESS);
+
+	if (timeout < 0) {
+		RETURN_FALSE;
+	}
+
+	RETURN_BOOL(pthreads_monitor_wait_ex(
+		&threaded->monitor,
+		MIN((uint64_t) timeout, PTHREADS_MONITOR_WAIT_MAX / 1000) * 1000,
+		PTHREADS_MONITOR_QUEUE_USER, key) == SUCCESS);
 } /* }}} */
 
-/* {{{ proto boolean ThreadedBase::notify()
-		Send notification to everyone waiting on the ThreadedBase
+/* {{{ proto boolean ThreadedBase::waitNs([int nanoseconds [, ?string key]])
+		Will cause the calling thread to wait for notification from the referenced object, for at most the given number
+		of nanoseconds as measured by a monotonic clock, if one is given
+		If a key is given, only notifications for the same key will end the wait
+		Returns false if the timeout was reached, true otherwise */
+PHP_METHOD(ThreadedBase, waitNs)
+{
+	pthreads_object_t* threaded = PTHREADS_FETCH_TS;
+	zend_long timeout = 0L;
+	zend_string *key = NULL;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 0, 2)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_LONG(timeout)
+		Z_PARAM_STR_OR_NULL(key)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (timeout < 0) {
+		zend_argument_value_error(1, "must be greater than or equal to 0");
+		RETURN_THROWS();
+	}
+
+	RETURN_BOOL(pthreads_monitor_wait_ex(&threaded->monitor, (uint64_t) timeout, PTHREADS_MONITOR_QUEUE_USER, key) == SUCCESS);
+} /* }}} */
+
+/* {{{ proto boolean ThreadedBase::notify([?string key])
+		Send notification to everyone waiting on the ThreadedBase for the given key, or without a key
 		Will return a boolean indication of success */
 PHP_METHOD(ThreadedBase, notify)
 {
 	pthreads_object_t* threaded = PTHREADS_FETCH_TS;
+	zend_string *key = NULL;
 
-	zend_parse_parameters_none_throw();
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 0, 1)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_STR_OR_NULL(key)
+	ZEND_PARSE_PARAMETERS_END();
 
-	RETURN_BOOL(pthreads_monitor_notify(&threaded->monitor) == SUCCESS);
+	RETURN_BOOL(pthreads_monitor_notify_ex(&threaded->monitor, PTHREADS_MONITOR_QUEUE_USER, key, 1) == SUCCESS);
 } /* }}} */
 
-/* {{{ proto boolean ThreadedBase::notifyOne()
-		Send notification to one context waiting on the ThreadedBase
+/* {{{ proto boolean ThreadedBase::notifyOne([?string key])
+		Send notification to the context which has waited longest on the ThreadedBase for the given key, or without a key
 		Will return a boolean indication of success */
 PHP_METHOD(ThreadedBase, notifyOne)
 {
 	pthreads_object_t* threaded = PTHREADS_FETCH_TS;
+	zend_string *key = NULL;
 
-	zend_parse_parameters_none_throw();
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 0, 1)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_STR_OR_NULL(key)
+	ZEND_PARSE_PARAMETERS_END();
 
-	RETURN_BOOL(pthreads_monitor_notify_one(&threaded->monitor) == SUCCESS);
+	RETURN_BOOL(pthreads_monitor_notify_ex(&threaded->monitor, PTHREADS_MONITOR_QUEUE_USER, key, 0) == SUCCESS);
 } /* }}} */
 
 /* {{{ proto void ThreadedBase::synchronized(Callable function, ...)
@@ -96,9 +139,395 @@ PHP_METHOD(ThreadedBase, synchronized)
 	zend_fcall_info_args_clear(&call.fci, 1);
 } /* }}} */
 
-/* {{{ proto Iterator ThreadedBase::getIterator() */
+/* {{{ */
+static int pthreads_threaded_base_read_member(zend_object *object, zval *key, zval *result) {
+	zval rv, *value;
+	zend_string *name = NULL;
+
+	ZVAL_UNDEF(&rv);
+
+	if (IS_PTHREADS_THREADED_ARRAY(object->ce)) {
+		value = object->handlers->read_dimension(object, key, BP_VAR_R, &rv);
+	} else {
+		name = zval_try_get_string(key);
+		if (!name) {
+			return FAILURE;
+		}
+		value = object->handlers->read_property(object, name, BP_VAR_R, NULL, &rv);
+	}
+
+	if (!EG(exception)) {
+		if (value == NULL || Z_ISUNDEF_P(value)) {
+			value = &EG(uninitialized_zval);
+		}
+
+		if (name) {
+			Z_TRY_ADDREF_P(value);
+			zend_symtable_update(Z_ARRVAL_P(result), name, value);
+		} else {
+			array_set_zval_key(Z_ARRVAL_P(result), key, value);
+		}
+	}
+
+	if (value == &rv) {
+		zval_ptr_dtor(&rv);
+	}
+	if (name) {
+		zend_string_release(name);
+	}
+
+	return EG(exception) ? FAILURE : SUCCESS;
+} /* }}} */
+
+/* {{{ */
+static int pthreads_threaded_base_write_member(zend_object *object, zend_ulong idx, zend_string *name, zval *value) {
+	if (IS_PTHREADS_THREADED_ARRAY(object->ce)) {
+		zval key;
+
+		if (name) {
+			ZVAL_STR(&key, name);
+		} else ZVAL_LONG(&key, idx);
+
+		object->handlers->write_dimension(object, &key, value);
+	} else {
+		if (name) {
+			object->handlers->write_property(object, name, value, NULL);
+		} else {
+			name = zend_long_to_str(idx);
+			object->handlers->write_property(object, name, value, NULL);
+			zend_string_release(name);
+		}
+	}
+
+	return EG(exception) ? FAILURE : SUCCESS;
+} /* }}} */
+
+/* {{{ proto array ThreadedBase::getMany(array keys)
+	Will read the given members while retaining the synchronization lock for the current context
+	Returns the values of the members keyed by name */
+PHP_METHOD(ThreadedBase, getMany)
+{
+	HashTable *keys;
+	zval *key;
+	zend_object *object = Z_OBJ_P(getThis());
+	pthreads_object_t* threaded = PTHREADS_FETCH_TS;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 1, 1)
+		Z_PARAM_ARRAY_HT(keys)
+	ZEND_PARSE_PARAMETERS_END();
+
+	array_init_size(return_value, zend_hash_num_elements(keys));
+
+	if (pthreads_monitor_lock(&threaded->monitor)) {
+		/* synchronize property tables, nothing can change them again until we're done */
+		pthreads_store_sync_local_properties(object);
+
+		zend_try {
+			ZEND_HASH_FOREACH_VAL(keys, key) {
+				if (pthreads_threaded_base_read_member(object, key, return_value) == FAILURE) {
+					break;
+				}
+			} ZEND_HASH_FOREACH_END();
+		} zend_catch {
+			pthreads_monitor_unlock(&threaded->monitor);
+			zend_bailout();
+		} zend_end_try();
+
+		pthreads_monitor_unlock(&threaded->monitor);
+	}
+} /* }}} */
+
+/* {{{ proto void ThreadedBase::setMany(array values)
+	Will write the given members while retaining the synchronization lock for the current context */
+PHP_METHOD(ThreadedBase, setMany)
+{
+	HashTable *values;
+	zend_ulong idx;
+	zend_string *name;
+	zval *value;
+	zend_object *object = Z_OBJ_P(getThis());
+	pthreads_object_t* threaded = PTHREADS_FETCH_TS;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 1, 1)
+		Z_PARAM_ARRAY_HT(values)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (pthreads_monitor_lock(&threaded->monitor)) {
+		zend_try {
+			ZEND_HASH_FOREACH_KEY_VAL(values, idx, name, value) {
+				ZVAL_DEREF(value);
+				if (pthreads_threaded_base_write_member(object, idx, name, value) == FAILURE) {
+					break;
+				}
+			} ZEND_HASH_FOREACH_END();
+		} zend_catch {
+			pthreads_monitor_unlock(&threaded->monitor);
+			zend_bailout();
+		} zend_end_try();
+
+		pthreads_monitor_unlock(&threaded->monitor);
+	}
+} /* }}} */
+
+/* {{{ Resolves the name and property slot of the member referred to by key, as the property handlers would
+	On success, member holds a new ref to the name, which must be released by the caller */
+static zend_bool pthreads_threaded_base_resolve_member(zend_object *object, zend_string *name, zend_long index, zval *member, uint32_t *slot, zend_property_info **info) {
+	*slot = PTHREADS_STORE_NO_SLOT;
+	*info = NULL;
+
+	if (IS_PTHREADS_THREADED_ARRAY(object->ce)) {
+		if (name) {
+			ZVAL_STR_COPY(member, name);
+		} else ZVAL_LONG(member, index);
+		return 1;
+	}
+
+	if (name) {
+		zend_string_addref(name);
+	} else name = zend_long_to_str(index);
+
+	*info = zend_get_property_info(object->ce, name, 0);
+	if (*info == ZEND_WRONG_PROPERTY_INFO) {
+		zend_string_release(name);
+		return 0;
+	}
+
+	if (*info != NULL && ((*info)->flags & ZEND_ACC_STATIC) == 0) {
+		//defined property, use mangled name
+		ZVAL_STR_COPY(member, (*info)->name);
+		*slot = OBJ_PROP_TO_NUM((*info)->offset);
+		zend_string_release(name);
+	} else {
+		ZVAL_STR(member, name);
+		*info = NULL;
+	}
+
+	return 1;
+} /* }}} */
+
+/* {{{ */
+static zend_bool pthreads_threaded_base_verify_member_type(zend_property_info *info, zval *value) {
+	if (info == NULL || !ZEND_TYPE_IS_SET(info->type)) {
+		return 1;
+	}
+
+	return zend_verify_property_type(info, value, ZEND_ARG_USES_STRICT_TYPES());
+} /* }}} */
+
+/* {{{ proto int|float|string|bool ThreadedBase::increment(string|int key [, int|float delta = 1])
+	Will add delta to the member while retaining the synchronization lock
+	Returns the new value of the member, which may have been coerced to the type of the property */
+PHP_METHOD(ThreadedBase, increment)
+{
+	zend_string *name = NULL;
+	zend_long index = 0;
+	zval *delta = NULL;
+	zval one, member;
+	uint32_t slot;
+	zend_property_info *info;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 1, 2)
+		Z_PARAM_STR_OR_LONG(name, index)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_NUMBER(delta)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (delta == NULL) {
+		ZVAL_LONG(&one, 1);
+		delta = &one;
+	}
+
+	if (!pthreads_threaded_base_resolve_member(Z_OBJ_P(getThis()), name, index, &member, &slot, &info)) {
+		RETURN_THROWS();
+	}
+
+	pthreads_store_increment(Z_OBJ_P(getThis()), &member, slot, info, delta, ZEND_ARG_USES_STRICT_TYPES(), return_value);
+
+	zval_ptr_dtor(&member);
+} /* }}} */
+
+/* {{{ proto bool ThreadedBase::compareAndSet(string|int key, mixed expected, mixed value)
+	Will set the member to value if its current value is identical to expected, while retaining the synchronization lock
+	Returns whether the member was set */
+PHP_METHOD(ThreadedBase, compareAndSet)
+{
+	zend_string *name = NULL;
+	zend_long index = 0;
+	zval *expected, *value;
+	zval member, verified;
+	uint32_t slot;
+	zend_property_info *info;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 3, 3)
+		Z_PARAM_STR_OR_LONG(name, index)
+		Z_PARAM_ZVAL(expected)
+		Z_PARAM_ZVAL(value)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (!pthreads_threaded_base_resolve_member(Z_OBJ_P(getThis()), name, index, &member, &slot, &info)) {
+		RETURN_THROWS();
+	}
+
+	ZVAL_COPY(&verified, value);
+	if (pthreads_threaded_base_verify_member_type(info, &verified)) {
+		RETVAL_BOOL(pthreads_store_compare_and_set(Z_OBJ_P(getThis()), &member, slot, expected, &verified) == SUCCESS);
+	}
+
+	zval_ptr_dtor(&verified);
+	zval_ptr_dtor(&member);
+} /* }}} */
+
+/* {{{ proto mixed ThreadedBase::fetchAndSet(string|int key, mixed value)
+	Will set the member to value while retaining the synchronization lock
+	Returns the previous value of the member */
+PHP_METHOD(ThreadedBase, fetchAndSet)
+{
+	zend_string *name = NULL;
+	zend_long index = 0;
+	zval *value;
+	zval member, verified;
+	uint32_t slot;
+	zend_property_info *info;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 2, 2)
+		Z_PARAM_STR_OR_LONG(name, index)
+		Z_PARAM_ZVAL(value)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (!pthreads_threaded_base_resolve_member(Z_OBJ_P(getThis()), name, index, &member, &slot, &info)) {
+		RETURN_THROWS();
+	}
+
+	ZVAL_COPY(&verified, value);
+	if (pthreads_threaded_base_verify_member_type(info, &verified)) {
+		if (pthreads_store_fetch_and_set(Z_OBJ_P(getThis()), &member, slot, &verified, return_value) != SUCCESS) {
+			zval_ptr_dtor(return_value);
+			ZVAL_NULL(return_value);
+		}
+	}
+
+	zval_ptr_dtor(&verified);
+	zval_ptr_dtor(&member);
+} /* }}} */
+
+/* {{{ proto bool ThreadedBase::waitUntil(string|int key, mixed expected [, int nanoseconds = 0])
+	Will cause the calling thread to wait until the member is identical to expected, for at most the given number of
+	nanoseconds if one is given; the condition is checked on every change to the members, without returning to user code
+	Returns whether the member is identical to expected */
+PHP_METHOD(ThreadedBase, waitUntil)
+{
+	zend_string *name = NULL;
+	zend_long index = 0;
+	zend_long timeout = 0L;
+	zval *expected;
+	zval member;
+	uint32_t slot;
+	zend_property_info *info;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 2, 3)
+		Z_PARAM_STR_OR_LONG(name, index)
+		Z_PARAM_ZVAL(expected)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_LONG(timeout)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (timeout < 0) {
+		zend_argument_value_error(3, "must be greater than or equal to 0");
+		RETURN_THROWS();
+	}
+
+	if (!pthreads_threaded_base_resolve_member(Z_OBJ_P(getThis()), name, index, &member, &slot, &info)) {
+		RETURN_THROWS();
+	}
+
+	RETVAL_BOOL(pthreads_store_wait_until(
+		Z_OBJ_P(getThis()), PTHREADS_STORE_CONDITION_IDENTICAL, &member, slot, expected, (uint64_t) timeout) == SUCCESS);
+
+	zval_ptr_dtor(&member);
+} /* }}} */
+
+/* {{{ proto bool ThreadedBase::waitUntilNotEmpty(string|int key [, int nanoseconds = 0])
+	Will cause the calling thread to wait until the member is set and not empty, for at most the given number of
+	nanoseconds if one is given
+	Returns whether the member is set and not empty */
+PHP_METHOD(ThreadedBase, waitUntilNotEmpty)
+{
+	zend_string *name = NULL;
+	zend_long index = 0;
+	zend_long timeout = 0L;
+	zval member;
+	uint32_t slot;
+	zend_property_info *info;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 1, 2)
+		Z_PARAM_STR_OR_LONG(name, index)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_LONG(timeout)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (timeout < 0) {
+		zend_argument_value_error(2, "must be greater than or equal to 0");
+		RETURN_THROWS();
+	}
+
+	if (!pthreads_threaded_base_resolve_member(Z_OBJ_P(getThis()), name, index, &member, &slot, &info)) {
+		RETURN_THROWS();
+	}
+
+	RETVAL_BOOL(pthreads_store_wait_until(
+		Z_OBJ_P(getThis()), PTHREADS_STORE_CONDITION_NOT_EMPTY, &member, slot, NULL, (uint64_t) timeout) == SUCCESS);
+
+	zval_ptr_dtor(&member);
+} /* }}} */
+
+/* {{{ proto bool ThreadedBase::waitUntilCount(int count [, int nanoseconds = 0])
+	Will cause the calling thread to wait until the object has at least count members, or items for a ThreadedQueue, for
+	at most the given number of nanoseconds if one is given
+	Returns whether the object has at least count members */
+PHP_METHOD(ThreadedBase, waitUntilCount)
+{
+	zend_long count;
+	zend_long timeout = 0L;
+	zval expected;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 1, 2)
+		Z_PARAM_LONG(count)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_LONG(timeout)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (timeout < 0) {
+		zend_argument_value_error(2, "must be greater than or equal to 0");
+		RETURN_THROWS();
+	}
+
+	ZVAL_LONG(&expected, count);
+	RETURN_BOOL(pthreads_store_wait_until(
+		Z_OBJ_P(getThis()), PTHREADS_STORE_CONDITION_COUNT, NULL, PTHREADS_STORE_NO_SLOT, &expected, (uint64_t) timeout) == SUCCESS);
+} /* }}} */
+
+/* {{{ proto Iterator ThreadedBase::getIterator([bool snapshot = false]) */
 PHP_METHOD(ThreadedBase, getIterator)
 {
-	ZEND_PARSE_PARAMETERS_NONE();
-	zend_create_internal_iterator_zval(return_value, getThis());
+	zend_bool snapshot = 0;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 0, 1)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_BOOL(snapshot)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (!snapshot) {
+		zend_create_internal_iterator_zval(return_value, getThis());
+		return;
+	}
+
+	zval members;
+
+	array_init(&members);
+	pthreads_store_snapshot(Z_OBJ_P(getThis()), Z_ARRVAL(members));
+
+	//the snapshot belongs to this thread, so it can be iterated without locking
+	object_init_ex(return_value, spl_ce_ArrayIterator);
+	zend_call_known_instance_method_with_1_params(spl_ce_ArrayIterator->constructor, Z_OBJ_P(return_value), NULL, &members);
+	zval_ptr_dtor(&members);
 } /* }}} */
@@ -0,0 +1,97 @@
+/*
+  +----------------------------------------------------------------------+
+  | pthreads                                                             |
+  +----------------------------------------------------------------------+
+  | Copyright (c) Joe Watkins 2012 - 2015                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Joe Watkins <krakjoe@php.net>                                |
+  +----------------------------------------------------------------------+
+ */
+
+#include <src/pthreads.h>
+#include <src/store.h>
+
+/* {{{ proto ThreadedQueue::__construct([int $capacity = 0])
+	Creates a queue which holds at most capacity items, or any number of items if capacity is 0 */
+PHP_METHOD(ThreadedQueue, __construct)
+{
+	zend_long capacity = 0;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 0, 1)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_LONG(capacity)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (capacity < 0) {
+		zend_argument_value_error(1, "must be greater than or equal to 0");
+		RETURN_THROWS();
+	}
+
+	pthreads_store_ring_set_capacity(Z_OBJ_P(getThis()), capacity);
+} /* }}} */
+
+/* {{{ proto boolean ThreadedQueue::push(mixed $value)
+	Will add the value to the end of the queue
+	Returns false if the queue is full */
+PHP_METHOD(ThreadedQueue, push)
+{
+	zval *value;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 1, 1)
+		Z_PARAM_ZVAL(value)
+	ZEND_PARSE_PARAMETERS_END();
+
+	RETURN_BOOL(pthreads_store_ring_push(Z_OBJ_P(getThis()), value) == SUCCESS);
+} /* }}} */
+
+/* {{{ proto mixed ThreadedQueue::shift([?int $timeout = null])
+	Will shift the first item from the queue, waiting up to timeout microseconds for one if the queue is empty
+	and a timeout is given; a timeout of 0 waits until an item is available */
+PHP_METHOD(ThreadedQueue, shift)
+{
+	zend_long timeout = -1;
+	zend_bool timeout_is_null = 1;
+
+	ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 0, 1)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_LONG_OR_NULL(timeout, timeout_is_null)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (timeout_is_null) {
+		timeout = -1;
+	} else if (timeout < 0) {
+		zend_argument_value_error(1, "must be greater than or equal to 0");
+		RETURN_THROWS();
+	}
+
+	pthreads_store_ring_shift(Z_OBJ_P(getThis()), timeout, return_value);
+} /* }}} */
+
+/* {{{ proto mixed ThreadedQueue::pop()
+	Will pop the last item from the queue */
+PHP_METHOD(ThreadedQueue, pop)
+{
+	zend_parse_parameters_none_throw();
+
+	pthreads_store_ring_pop(Z_OBJ_P(getThis()), return_value);
+} /* }}} */
+
+/* {{{ proto int ThreadedQueue::count()
+	Will return the number of items in the queue */
+PHP_METHOD(ThreadedQueue, count)
+{
+	zend_parse_parameters_none_throw();
+
+	ZVAL_LONG(return_value, 0);
+
+	pthreads_store_ring_count(
+		Z_OBJ_P(getThis()), &Z_LVAL_P(return_value));
+} /* }}} */
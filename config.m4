@@ -7,6 +7,9 @@ PHP_ARG_WITH(pthreads-sanitize, whether to enable AddressSanitizer for pthreads,
 PHP_ARG_WITH(pthreads-dmalloc, whether to enable dmalloc for pthreads,
 [  --with-pthreads-dmalloc   Enable dmalloc for pthreads], no, no)
 
+PHP_ARG_ENABLE(pthreads-futex, whether to build pthreads monitors on futexes,
+[  --enable-pthreads-futex   Experimental: use Linux futexes instead of pthread mutexes and condition variables for monitors], no, no)
+
 if test "$PHP_PTHREADS" != "no"; then
 	AC_MSG_CHECKING([for ZTS])   
 	if test "$PHP_THREAD_SAFETY" != "no"; then
@@ -27,8 +30,18 @@ if test "$PHP_PTHREADS" != "no"; then
 		EXTRA_CFLAGS="$EXTRA_CFLAGS -DDMALLOC"
 	fi
 
-	CLASSES_SRC="classes/pool.c classes/thread.c classes/threaded_array.c classes/threaded_base.c classes/threaded_runnable.c classes/worker.c"
-	PHP_NEW_EXTENSION(pthreads, php_pthreads.c $CLASSES_SRC src/copy.c src/monitor.c src/worker.c src/globals.c src/prepare.c src/store.c src/resources.c src/handlers.c src/object.c src/queue.c src/ext_sockets_hacks.c, $ext_shared,, -DZEND_ENABLE_STATIC_TSRMLS_CACHE=1 -Werror=implicit-function-declaration)
+	AC_CHECK_FUNCS([pthread_condattr_setclock])
+
+	if test "$PHP_PTHREADS_FUTEX" != "no"; then
+		AC_CHECK_HEADER([linux/futex.h], [
+			AC_DEFINE(PTHREADS_MONITOR_FUTEX, 1, [Whether pthreads monitors are built on futexes])
+		], [
+			AC_MSG_ERROR([--enable-pthreads-futex requires linux/futex.h])
+		])
+	fi
+
+	CLASSES_SRC="classes/pool.c classes/thread.c classes/threaded_array.c classes/threaded_atomic_float.c classes/threaded_atomic_int.c classes/threaded_base.c classes/threaded_queue.c classes/threaded_runnable.c classes/worker.c"
+	PHP_NEW_EXTENSION(pthreads, php_pthreads.c $CLASSES_SRC src/copy.c src/monitor.c src/worker.c src/globals.c src/prepare.c src/store.c src/resources.c src/handlers.c src/object.c src/queue.c src/slab.c src/ext_sockets_hacks.c, $ext_shared,, -DZEND_ENABLE_STATIC_TSRMLS_CACHE=1 -Werror=implicit-function-declaration)
 	PHP_ADD_BUILD_DIR($ext_builddir/src, 1)
 	PHP_ADD_INCLUDE($ext_builddir)
 
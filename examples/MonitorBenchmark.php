@@ -0,0 +1,104 @@
+<?php
+/**
+* This file serves as a benchmark for lock-heavy workloads, for comparing builds with and without --enable-pthreads-futex,
+* or different pthreads.monitor_spin settings (php-zts -d pthreads.monitor_spin=0 ... disables spinning)
+* usage: php-zts examples/MonitorBenchmark.php [threads] [operations] [samples]
+*   threads - the number of threads to create, default=4
+*   operations - the number of operations each thread performs per test, default=100000
+*   samples - the number of times to run each test, default=5
+*/
+
+$threads = @$argv[1] ? (int) $argv[1] : 4;
+$operations = @$argv[2] ? (int) $argv[2] : 100000;
+$samples = @$argv[3] ? (int) $argv[3] : 5;
+
+function info(string $pattern) : string {
+	ob_start();
+	phpinfo(INFO_MODULES);
+	return preg_match($pattern, ob_get_clean(), $match) ? $match[1] : "unknown";
+}
+
+printf("Monitors: %s, spin: %s, threads: %d, operations: %d\n",
+	info('/Monitors => (.+)/'), ini_get("pthreads.monitor_spin"), $threads, $operations);
+
+class Counter extends ThreadedBase {
+	public $value = 0;
+}
+
+class BenchmarkThread extends Thread {
+	public function __construct(
+		private string $test,
+		private ThreadedArray $array,
+		private Counter $counter,
+		private int $id,
+		private int $operations
+	) {}
+
+	public function run() : void {
+		switch ($this->test) {
+			case "write":
+				//every write takes the monitor exclusively
+				for ($i = 0; $i < $this->operations; $i++) {
+					$this->array[$i & 1023] = $this->id;
+				}
+				break;
+
+			case "read/write":
+				//one write for every four reads, so readers are regularly invalidated
+				for ($i = 0; $i < $this->operations; $i++) {
+					if (($i & 3) === 0) {
+						$this->array[$i & 1023] = $this->id;
+					} else {
+						$value = $this->array[$i & 1023];
+					}
+				}
+				break;
+
+			case "synchronized":
+				//nested, recursive acquisition of the same monitor
+				for ($i = 0; $i < $this->operations; $i++) {
+					$this->counter->synchronized(function() : void {
+						$this->counter->value++;
+					});
+				}
+				break;
+
+			case "queue":
+				for ($i = 0; $i < $this->operations; $i++) {
+					$this->array[] = $i;
+					$this->array->shift();
+				}
+				break;
+		}
+	}
+}
+
+foreach (["write", "read/write", "synchronized", "queue"] as $test) {
+	$results = [];
+	$blocked = (int) info('/Blocked => (\d+)/');
+	printf("%-14s", $test);
+
+	for ($sample = 0; $sample < $samples; $sample++) {
+		$array = new ThreadedArray;
+		$counter = new Counter;
+		for ($i = 0; $i < 1024; $i++) {
+			$array[$i] = 0;
+		}
+
+		$start = microtime(true);
+		$workers = [];
+		for ($id = 0; $id < $threads; $id++) {
+			$workers[$id] = new BenchmarkThread($test, $array, $counter, $id, $operations);
+			$workers[$id]->start();
+		}
+		foreach ($workers as $worker) {
+			$worker->join();
+		}
+		$results[] = ($threads * $operations) / (microtime(true) - $start);
+		printf(".");
+	}
+
+	//every blocked acquisition costs at least one context switch
+	printf(" %.0f ops/s, %d blocked\n", array_sum($results) / count($results), (int) info('/Blocked => (\d+)/') - $blocked);
+}
+?>
@@ -254,6 +254,15 @@ final class ThreadedArray extends ThreadedBase implements Countable, ArrayAccess
      */
     public function chunk(int $size, bool $preserve = false) : array{}
 
+    /**
+     * Creates a new ThreadedArray with the same members as this one
+     *
+     * The members aren't copied until they are written, so this is much cheaper than copying an array.
+     *
+     * @return ThreadedArray A new ThreadedArray object
+     */
+    public function copy() : ThreadedArray{}
+
     /**
      * {@inheritdoc}
      */
@@ -291,6 +300,18 @@ final class ThreadedArray extends ThreadedBase implements Countable, ArrayAccess
      */
     public function shift() : mixed{}
 
+    /**
+     * Copies the members of the array to a plain array
+     *
+     * Each ThreadedArray is locked once while its members are copied, which is much cheaper than reading members
+     * one at a time. An Error is thrown if a ThreadedArray contains itself and $recursive is true.
+     *
+     * @param bool $recursive Convert nested ThreadedArrays to arrays too
+     *
+     * @return array An array of the members of this ThreadedArray
+     */
+    public function toArray(bool $recursive = true) : array{}
+
 	public function offsetGet(mixed $offset) : mixed{}
 
 	public function offsetSet(mixed $offset, mixed $value) : void{}
@@ -301,6 +322,177 @@ final class ThreadedArray extends ThreadedBase implements Countable, ArrayAccess
 }
 
 
+/**
+ * ThreadedQueue objects are first-in-first-out queues which can be shared between threads.
+ *
+ * Items are kept in a ring buffer, so pushing and shifting take constant time regardless of how many items have
+ * passed through the queue.
+ *
+ * @generate-class-entries
+ * @strict-properties
+ */
+final class ThreadedQueue extends ThreadedBase implements Countable
+{
+    /**
+     * @param int $capacity The maximum number of items in the queue, or 0 for no limit
+     */
+    public function __construct(int $capacity = 0){}
+
+    /**
+     * Adds an item to the end of the queue
+     *
+     * @param mixed $value The item to add
+     *
+     * @return bool false if the queue is full
+     */
+    public function push(mixed $value) : bool{}
+
+    /**
+     * Removes the first item from the queue
+     *
+     * @param int|null $timeout If not null, the number of microseconds to wait for an item if the queue is empty,
+     * or 0 to wait until one is available
+     *
+     * @return mixed The first item in the queue, or null if there was none
+     */
+    public function shift(?int $timeout = null) : mixed{}
+
+    /**
+     * Removes the last item from the queue
+     *
+     * @return mixed The last item in the queue, or null if there was none
+     */
+    public function pop() : mixed{}
+
+    /**
+     * {@inheritdoc}
+     */
+    public function count() : int{}
+}
+
+
+/**
+ * ThreadedAtomicInt objects hold a single integer which can be shared between threads.
+ *
+ * All operations are performed with atomic instructions rather than by acquiring the synchronization lock, which
+ * makes these objects well suited for counters and flags which are updated frequently by many threads.
+ *
+ * Unlike regular integers, the value wraps around on overflow instead of becoming a float.
+ *
+ * @generate-class-entries
+ * @strict-properties
+ */
+final class ThreadedAtomicInt extends ThreadedBase
+{
+    /**
+     * @param int $value The initial value
+     */
+    public function __construct(int $value = 0){}
+
+    /**
+     * Gets the value
+     *
+     * @return int The current value
+     */
+    public function get() : int{}
+
+    /**
+     * Sets the value
+     *
+     * @param int $value The new value
+     */
+    public function set(int $value) : void{}
+
+    /**
+     * Adds delta to the value
+     *
+     * @param int $delta The amount to add
+     *
+     * @return int The new value
+     */
+    public function add(int $delta = 1) : int{}
+
+    /**
+     * Sets the value, returning the previous value
+     *
+     * @param int $value The new value
+     *
+     * @return int The previous value
+     */
+    public function swap(int $value) : int{}
+
+    /**
+     * Sets the value, only if the current value is equal to expected
+     *
+     * @param int $expected The value which must currently be held
+     * @param int $value The new value
+     *
+     * @return bool Whether the value was set
+     */
+    public function compareExchange(int $expected, int $value) : bool{}
+}
+
+
+/**
+ * ThreadedAtomicFloat objects hold a single floating point number which can be shared between threads.
+ *
+ * All operations are performed with atomic instructions rather than by acquiring the synchronization lock, which
+ * makes these objects well suited for counters and flags which are updated frequently by many threads.
+ *
+ * @generate-class-entries
+ * @strict-properties
+ */
+final class ThreadedAtomicFloat extends ThreadedBase
+{
+    /**
+     * @param float $value The initial value
+     */
+    public function __construct(float $value = 0.0){}
+
+    /**
+     * Gets the value
+     *
+     * @return float The current value
+     */
+    public function get() : float{}
+
+    /**
+     * Sets the value
+     *
+     * @param float $value The new value
+     */
+    public function set(float $value) : void{}
+
+    /**
+     * Adds delta to the value
+     *
+     * @param float $delta The amount to add
+     *
+     * @return float The new value
+     */
+    public function add(float $delta = 1.0) : float{}
+
+    /**
+     * Sets the value, returning the previous value
+     *
+     * @param float $value The new value
+     *
+     * @return float The previous value
+     */
+    public function swap(float $value) : float{}
+
+    /**
+     * Sets the value, only if the current value is equal to expected
+     *
+     * @param float $expected The value which must currently be held
+     * @param float $value The new value
+     *
+     * @return bool Whether the value was set
+     */
+    public function compareExchange(float $expected, float $value) : bool{}
+}
+
+
 /**
  * ThreadedBase class
  *
@@ -319,17 +511,24 @@ class ThreadedBase implements IteratorAggregate
     /**
      * Send notification to the referenced object
      *
+     * Only contexts which are waiting for the same key, or without a key if none is given, are woken.
+     *
+     * @param string|null $key The condition to notify waiters of
+     *
      * @link http://www.php.net/manual/en/threaded.notify.php
      * @return bool A boolean indication of success
      */
-    public function notify() : bool{}
+    public function notify(?string $key = null) : bool{}
 
     /**
-     * Send notification to one context waiting on the Threaded
+     * Send notification to the context which has waited longest on the Threaded for the same key, or without a key if
+     * none is given
+     *
+     * @param string|null $key The condition to notify a waiter of
      *
      * @return bool A boolean indication of success
      */
-    public function notifyOne() : bool{}
+    public function notifyOne(?string $key = null) : bool{}
 
     /**
      * Executes the block while retaining the synchronization lock for the current context.
@@ -345,14 +544,122 @@ class ThreadedBase implements IteratorAggregate
     /**
      * Waits for notification from the Stackable
      *
+     * The synchronization lock must be held while waiting. If a key is given, only notifications for the same key
+     * will end the wait, so that unrelated notifications don't wake this context.
+     *
      * @param int $timeout An optional timeout in microseconds
+     * @param string|null $key The condition to wait for notification of
      *
      * @link http://www.php.net/manual/en/threaded.wait.php
-     * @return bool A boolean indication of success
+     * @return bool false if the timeout was reached or the lock isn't held, true if notified
+     */
+    public function wait(int $timeout = 0, ?string $key = null) : bool{}
+
+    /**
+     * Waits for notification from the referenced object, with a timeout in nanoseconds
+     *
+     * The timeout is measured by a monotonic clock where the platform allows it, so changes to the system time don't
+     * make the wait end early or late.
+     *
+     * @param int $nanoseconds An optional timeout in nanoseconds; 0 waits until notified
+     * @param string|null $key The condition to wait for notification of
+     *
+     * @return bool false if the timeout was reached or the lock isn't held, true if notified
+     */
+    public function waitNs(int $nanoseconds = 0, ?string $key = null) : bool{}
+
+    /**
+     * Reads several members while retaining the synchronization lock, so that the values are consistent with each other
+     *
+     * @param array $keys The names of the members to read
+     *
+     * @return array The values of the members, keyed by name
+     */
+    public function getMany(array $keys) : array{}
+
+    /**
+     * Writes several members while retaining the synchronization lock, so that other contexts see either none or all of the changes
+     *
+     * @param array $values The values to write, keyed by member name
      */
-    public function wait(int $timeout = 0) : bool{}
+    public function setMany(array $values) : void{}
 
-	public function getIterator() : Iterator{}
+    /**
+     * Adds delta to a numeric member while retaining the synchronization lock, as ++ would; undefined and null members
+     * count as 0, numeric strings are converted, and uninitialized typed properties throw
+     *
+     * @param string|int $key The name of the member
+     * @param int|float $delta The amount to add
+     *
+     * @return int|float|string|bool The new value of the member, which may be coerced to the type of the property
+     */
+    public function increment(string|int $key, int|float $delta = 1) : int|float|string|bool{}
+
+    /**
+     * Sets a member to value, only if its current value is identical to expected, while retaining the synchronization lock
+     *
+     * @param string|int $key The name of the member
+     * @param mixed $expected The value the member must currently have; undefined members have the value null
+     * @param mixed $value The new value
+     *
+     * @return bool Whether the member was set
+     */
+    public function compareAndSet(string|int $key, mixed $expected, mixed $value) : bool{}
+
+    /**
+     * Sets a member to value while retaining the synchronization lock
+     *
+     * @param string|int $key The name of the member
+     * @param mixed $value The new value
+     *
+     * @return mixed The previous value of the member
+     */
+    public function fetchAndSet(string|int $key, mixed $value) : mixed{}
+
+    /**
+     * Waits until a member is identical (===) to expected. The condition is checked natively whenever the members of
+     * this object change, so the calling context only resumes once it holds or the timeout is reached.
+     *
+     * @param string|int $key The name of the member
+     * @param mixed $expected The value to wait for; undefined members have the value null
+     * @param int $nanoseconds An optional timeout in nanoseconds; 0 waits until the condition holds
+     *
+     * @return bool Whether the member is identical to expected
+     */
+    public function waitUntil(string|int $key, mixed $expected, int $nanoseconds = 0) : bool{}
+
+    /**
+     * Waits until a member is set and not empty, as by !empty()
+     *
+     * @param string|int $key The name of the member
+     * @param int $nanoseconds An optional timeout in nanoseconds; 0 waits until the condition holds
+     *
+     * @return bool Whether the member is set and not empty
+     */
+    public function waitUntilNotEmpty(string|int $key, int $nanoseconds = 0) : bool{}
+
+    /**
+     * Waits until this object has at least the given number of members, or items for a ThreadedQueue
+     *
+     * @param int $count The number of members to wait for
+     * @param int $nanoseconds An optional timeout in nanoseconds; 0 waits until the condition holds
+     *
+     * @return bool Whether this object has at least count members
+     */
+    public function waitUntilCount(int $count, int $nanoseconds = 0) : bool{}
+
+    /**
+     * Returns an iterator over the members of this object
+     *
+     * By default, each step of the iteration reads the current state of the object. If snapshot is true, all members
+     * are copied at once while retaining the synchronization lock, and the iteration doesn't observe later changes.
+     * This is much faster for large objects.
+     *
+     * @param bool $snapshot Whether to iterate over a copy of the members taken now
+     *
+     * @return Iterator
+     */
+    public function getIterator(bool $snapshot = false) : Iterator{}
 }
 
 
@@ -364,6 +671,19 @@ class ThreadedConnectionException extends \RuntimeException{
 }
 
 
+/**
+ * Attribute which opts a ThreadedBase class into reader/writer locking.
+ *
+ * Objects of classes marked with this attribute allow any number of threads to read, isset(), count() and iterate their
+ * members concurrently. Writes and synchronized() blocks remain exclusive, and wait()/notify() behave as usual.
+ *
+ * @generate-class-entries
+ */
+final class ThreadedReadWriteLock
+{
+}
+
+
 /**
  * ThreadedRunnable class
  *
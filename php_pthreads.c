@@ -22,9 +22,13 @@
 #include <stubs/Pool_arginfo.h>
 #include <stubs/Thread_arginfo.h>
 #include <stubs/ThreadedArray_arginfo.h>
+#include <stubs/ThreadedAtomicFloat_arginfo.h>
+#include <stubs/ThreadedAtomicInt_arginfo.h>
 #include <stubs/ThreadedBase_arginfo.h>
+#include <stubs/ThreadedQueue_arginfo.h>
 #include <stubs/ThreadedRunnable_arginfo.h>
 #include <stubs/ThreadedConnectionException_arginfo.h>
+#include <stubs/ThreadedReadWriteLock_arginfo.h>
 #include <stubs/Worker_arginfo.h>
 
 #include <php_pthreads.h>
@@ -76,11 +80,15 @@ zend_module_entry pthreads_module_entry = {
 
 zend_class_entry *pthreads_threaded_base_entry;
 zend_class_entry *pthreads_threaded_array_entry;
+zend_class_entry *pthreads_threaded_queue_entry;
+zend_class_entry *pthreads_threaded_atomic_int_entry;
+zend_class_entry *pthreads_threaded_atomic_float_entry;
 zend_class_entry *pthreads_threaded_runnable_entry;
 zend_class_entry *pthreads_thread_entry;
 zend_class_entry *pthreads_worker_entry;
 zend_class_entry *pthreads_pool_entry;
 zend_class_entry *pthreads_ce_ThreadedConnectionException;
+zend_class_entry *pthreads_ce_ThreadedReadWriteLock;
 
 zend_object_handlers pthreads_threaded_base_handlers;
 zend_object_handlers pthreads_threaded_array_handlers;
@@ -116,11 +124,28 @@ static inline zend_bool pthreads_is_supported_sapi(char *name) {
 	return 0;
 }
 
+/* {{{ */
+static PHP_INI_MH(OnUpdateMonitorSpin) {
+	zend_long limit = ZEND_STRTOL(ZSTR_VAL(new_value), NULL, 10);
+
+	if (limit < 0) {
+		return FAILURE;
+	}
+	pthreads_monitor_set_spin_limit(limit);
+
+	return SUCCESS;
+} /* }}} */
+
+PHP_INI_BEGIN()
+	PHP_INI_ENTRY("pthreads.monitor_spin", ZEND_TOSTR(PTHREADS_MONITOR_SPIN_DEFAULT), PHP_INI_SYSTEM, OnUpdateMonitorSpin)
+PHP_INI_END()
+
 static inline void pthreads_globals_ctor(zend_pthreads_globals *pg) {
 	ZVAL_UNDEF(&pg->this);
 	pg->pid = 0L;
 	pg->signal = 0;
 	pg->resources = NULL;
+	memset(&pg->slab_cache, 0, sizeof(pthreads_slab_cache_t));
 }
 
 PHP_MINIT_FUNCTION(pthreads)
@@ -151,8 +176,17 @@ PHP_MINIT_FUNCTION(pthreads)
 	pthreads_threaded_array_entry = register_class_ThreadedArray(pthreads_threaded_base_entry, zend_ce_countable, zend_ce_arrayaccess);
 	pthreads_threaded_array_entry->create_object = pthreads_threaded_array_ctor;
 
+	pthreads_threaded_queue_entry = register_class_ThreadedQueue(pthreads_threaded_base_entry, zend_ce_countable);
+	pthreads_threaded_queue_entry->create_object = pthreads_threaded_queue_ctor;
+
+	pthreads_threaded_atomic_int_entry = register_class_ThreadedAtomicInt(pthreads_threaded_base_entry);
+	pthreads_threaded_atomic_float_entry = register_class_ThreadedAtomicFloat(pthreads_threaded_base_entry);
+
 	pthreads_ce_ThreadedConnectionException = register_class_ThreadedConnectionException(spl_ce_RuntimeException);
 
+	pthreads_ce_ThreadedReadWriteLock = register_class_ThreadedReadWriteLock();
+	zend_internal_attribute_register(pthreads_ce_ThreadedReadWriteLock, ZEND_ATTRIBUTE_TARGET_CLASS);
+
 	pthreads_threaded_runnable_entry = register_class_ThreadedRunnable(pthreads_threaded_base_entry);
 
 	pthreads_thread_entry = register_class_Thread(pthreads_threaded_runnable_entry);
@@ -200,11 +234,16 @@ PHP_MINIT_FUNCTION(pthreads)
 
 	ZEND_INIT_MODULE_GLOBALS(pthreads, pthreads_globals_ctor, NULL);
 
+	REGISTER_INI_ENTRIES();
+
 #if HAVE_PTHREADS_EXT_SOCKETS_SUPPORT
 	pthreads_ext_sockets_hacks_init();
 #endif
 
 	if (pthreads_globals_init()) {
+		if (pthreads_slab_init() == FAILURE) {
+			return FAILURE;
+		}
 		TSRMLS_CACHE_UPDATE();
 
 		/*
@@ -228,8 +267,11 @@ static inline int sapi_cli_deactivate(void)
 
 PHP_MSHUTDOWN_FUNCTION(pthreads)
 {
+	UNREGISTER_INI_ENTRIES();
+
 	if (pthreads_instance == TSRMLS_CACHE) {
 		pthreads_globals_shutdown();
+		pthreads_slab_shutdown();
 
 		if (memcmp(sapi_module.name, ZEND_STRL("cli")) == SUCCESS) {
 			sapi_module.deactivate = sapi_cli_deactivate;
@@ -247,6 +289,8 @@ ZEND_MODULE_POST_ZEND_DEACTIVATE_D(pthreads)
 		PTHREADS_ZG(resources) = NULL;
 	}
 	zend_hash_destroy(&PTHREADS_ZG(resolve));
+	//this thread may not allocate again, so let others reuse what it cached
+	pthreads_slab_flush();
 
 	return SUCCESS;
 }
@@ -283,5 +327,43 @@ PHP_MINFO_FUNCTION(pthreads)
 {
 	php_info_print_table_start();
 	php_info_print_table_row(2, "Version", PHP_PTHREADS_VERSION);
+#ifdef PTHREADS_MONITOR_FUTEX
+	php_info_print_table_row(2, "Monitors", "futex");
+#else
+	php_info_print_table_row(2, "Monitors", "pthread mutex");
+#endif
+	php_info_print_table_end();
+
+	pthreads_slab_stats_t stats;
+	char buffer[32];
+
+	pthreads_slab_get_stats(&stats);
+	php_info_print_table_start();
+	php_info_print_table_header(2, "Storage allocations", "Count");
+	snprintf(buffer, sizeof(buffer), ZEND_ULONG_FMT, (zend_ulong) stats.allocations);
+	php_info_print_table_row(2, "Total", buffer);
+	snprintf(buffer, sizeof(buffer), ZEND_ULONG_FMT, (zend_ulong) (stats.allocations - stats.slabs - stats.oversized));
+	php_info_print_table_row(2, "Avoided malloc()", buffer);
+	snprintf(buffer, sizeof(buffer), ZEND_ULONG_FMT, (zend_ulong) stats.cache_hits);
+	php_info_print_table_row(2, "Served from thread cache", buffer);
+	snprintf(buffer, sizeof(buffer), ZEND_ULONG_FMT, (zend_ulong) stats.slabs);
+	php_info_print_table_row(2, "Slabs", buffer);
 	php_info_print_table_end();
+
+	pthreads_monitor_stats_t contention;
+
+	pthreads_monitor_get_stats(&contention);
+	php_info_print_table_start();
+	php_info_print_table_header(2, "Monitor contention", "Count");
+	snprintf(buffer, sizeof(buffer), ZEND_ULONG_FMT, (zend_ulong) contention.contended);
+	php_info_print_table_row(2, "Contended acquisitions", buffer);
+	snprintf(buffer, sizeof(buffer), ZEND_ULONG_FMT, (zend_ulong) contention.spun);
+	php_info_print_table_row(2, "Acquired by spinning", buffer);
+	snprintf(buffer, sizeof(buffer), ZEND_ULONG_FMT, (zend_ulong) contention.blocked);
+	php_info_print_table_row(2, "Blocked", buffer);
+	snprintf(buffer, sizeof(buffer), ZEND_ULONG_FMT, (zend_ulong) contention.yields);
+	php_info_print_table_row(2, "Yields", buffer);
+	php_info_print_table_end();
+
+	DISPLAY_INI_ENTRIES();
 }
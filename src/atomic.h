@@ -0,0 +1,153 @@
+/*
+  +----------------------------------------------------------------------+
+  | pthreads                                                             |
+  +----------------------------------------------------------------------+
+  | Copyright (c) Joe Watkins 2012 - 2015                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Joe Watkins <krakjoe@php.net>                                |
+  +----------------------------------------------------------------------+
+ */
+
+/*
+* Minimal atomic helpers for the few places where pthreads reads shared state without holding a monitor
+*/
+#ifndef HAVE_PTHREADS_ATOMIC_H
+#define HAVE_PTHREADS_ATOMIC_H
+
+#include <stdint.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+
+/* {{{ x86/x64 MSVC: volatile accesses are acquire/release, interlocked operations are full barriers */
+static zend_always_inline uint32_t pthreads_atomic_load_u32(const volatile uint32_t *p) {
+	uint32_t v = *p;
+	_ReadWriteBarrier();
+	return v;
+}
+
+static zend_always_inline void pthreads_atomic_store_u32(volatile uint32_t *p, uint32_t v) {
+	_ReadWriteBarrier();
+	*p = v;
+}
+
+static zend_always_inline uint32_t pthreads_atomic_fetch_add_u32(volatile uint32_t *p, uint32_t v) {
+	return (uint32_t) _InterlockedExchangeAdd((volatile long *) p, (long) v);
+}
+
+static zend_always_inline uint32_t pthreads_atomic_fetch_sub_u32(volatile uint32_t *p, uint32_t v) {
+	return (uint32_t) _InterlockedExchangeAdd((volatile long *) p, -(long) v);
+}
+
+static zend_always_inline zend_bool pthreads_atomic_compare_exchange_u32(volatile uint32_t *p, uint32_t *expected, uint32_t desired) {
+	uint32_t previous = (uint32_t) _InterlockedCompareExchange((volatile long *) p, (long) desired, (long) *expected);
+	if (previous == *expected) {
+		return 1;
+	}
+	*expected = previous;
+	return 0;
+}
+
+static zend_always_inline uint32_t pthreads_atomic_exchange_u32(volatile uint32_t *p, uint32_t v) {
+	return (uint32_t) _InterlockedExchange((volatile long *) p, (long) v);
+}
+
+static zend_always_inline uint64_t pthreads_atomic_fetch_add_u64(volatile uint64_t *p, uint64_t v) {
+	return (uint64_t) _InterlockedExchangeAdd64((volatile __int64 *) p, (__int64) v);
+}
+
+static zend_always_inline uint64_t pthreads_atomic_load_u64(const volatile uint64_t *p) {
+	//plain 64-bit loads aren't atomic on x86
+	return (uint64_t) _InterlockedCompareExchange64((volatile __int64 *) p, 0, 0);
+}
+
+static zend_always_inline zend_bool pthreads_atomic_compare_exchange_u64(volatile uint64_t *p, uint64_t *expected, uint64_t desired) {
+	uint64_t previous = (uint64_t) _InterlockedCompareExchange64((volatile __int64 *) p, (__int64) desired, (__int64) *expected);
+	if (previous == *expected) {
+		return 1;
+	}
+	*expected = previous;
+	return 0;
+}
+
+static zend_always_inline uint64_t pthreads_atomic_exchange_u64(volatile uint64_t *p, uint64_t v) {
+	uint64_t expected = pthreads_atomic_load_u64(p);
+	while (!pthreads_atomic_compare_exchange_u64(p, &expected, v));
+	return expected;
+}
+
+static zend_always_inline void pthreads_atomic_store_u64(volatile uint64_t *p, uint64_t v) {
+	pthreads_atomic_exchange_u64(p, v);
+}
+
+static zend_always_inline void pthreads_atomic_fence_acquire(void) {
+	_ReadWriteBarrier();
+}
+
+static zend_always_inline void pthreads_atomic_fence_release(void) {
+	_ReadWriteBarrier();
+} /* }}} */
+#else
+/* {{{ GCC/clang builtins */
+static zend_always_inline uint32_t pthreads_atomic_load_u32(const volatile uint32_t *p) {
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static zend_always_inline void pthreads_atomic_store_u32(volatile uint32_t *p, uint32_t v) {
+	__atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static zend_always_inline uint32_t pthreads_atomic_fetch_add_u32(volatile uint32_t *p, uint32_t v) {
+	return __atomic_fetch_add(p, v, __ATOMIC_RELAXED);
+}
+
+static zend_always_inline uint32_t pthreads_atomic_fetch_sub_u32(volatile uint32_t *p, uint32_t v) {
+	return __atomic_fetch_sub(p, v, __ATOMIC_ACQ_REL);
+}
+
+static zend_always_inline zend_bool pthreads_atomic_compare_exchange_u32(volatile uint32_t *p, uint32_t *expected, uint32_t desired) {
+	return __atomic_compare_exchange_n(p, expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static zend_always_inline uint32_t pthreads_atomic_exchange_u32(volatile uint32_t *p, uint32_t v) {
+	return __atomic_exchange_n(p, v, __ATOMIC_ACQ_REL);
+}
+
+static zend_always_inline uint64_t pthreads_atomic_fetch_add_u64(volatile uint64_t *p, uint64_t v) {
+	return __atomic_fetch_add(p, v, __ATOMIC_RELAXED);
+}
+
+static zend_always_inline uint64_t pthreads_atomic_load_u64(const volatile uint64_t *p) {
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static zend_always_inline zend_bool pthreads_atomic_compare_exchange_u64(volatile uint64_t *p, uint64_t *expected, uint64_t desired) {
+	return __atomic_compare_exchange_n(p, expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static zend_always_inline uint64_t pthreads_atomic_exchange_u64(volatile uint64_t *p, uint64_t v) {
+	return __atomic_exchange_n(p, v, __ATOMIC_ACQ_REL);
+}
+
+static zend_always_inline void pthreads_atomic_store_u64(volatile uint64_t *p, uint64_t v) {
+	__atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static zend_always_inline void pthreads_atomic_fence_acquire(void) {
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+static zend_always_inline void pthreads_atomic_fence_release(void) {
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+} /* }}} */
+#endif
+
+#endif /* HAVE_PTHREADS_ATOMIC_H */
@@ -27,6 +27,28 @@
 
 typedef uint32_t zend_guard;
 
+/* {{{ The VM reads and writes properties directly, bypassing our handlers, if cache_slot[0] matches the object's class.
+	We must never allow that for thread-safe objects, so we key our entries with a tagged class pointer instead, which
+	no real class can ever match. cache_slot[2] holds the property_info, or NULL for dynamic properties */
+#define PTHREADS_CACHE_TAG(ce) ((void*) (((uintptr_t) (ce)) | 1))
+
+static zend_always_inline zend_property_info* pthreads_get_property_info_cached(zend_object *object, zend_string *member, int silent, void **cache_slot) {
+	zend_property_info *info;
+
+	if (cache_slot && cache_slot[0] == PTHREADS_CACHE_TAG(object->ce)) {
+		return (zend_property_info*) cache_slot[2];
+	}
+
+	info = zend_get_property_info(object->ce, member, silent);
+	if (cache_slot && info != ZEND_WRONG_PROPERTY_INFO) {
+		//errors (e.g. visibility violations) are never cached, so that they're raised on every access
+		cache_slot[0] = PTHREADS_CACHE_TAG(object->ce);
+		cache_slot[2] = info;
+	}
+
+	return info;
+} /* }}} */
+
 /* {{{ */
 int pthreads_count_properties(PTHREADS_COUNT_PASSTHRU_D) {
 	return pthreads_store_count(object, count);
@@ -78,7 +100,7 @@ zval* pthreads_read_property(PTHREADS_READ_PROPERTY_PASSTHRU_D) {
 		zend_call_known_instance_method_with_1_params(object->ce->__get, object, rv, &zmember);
 		(*guard) &= ~IN_GET;
 	} else {
-		zend_property_info* info = zend_get_property_info(object->ce, member, 0);
+		zend_property_info* info = pthreads_get_property_info_cached(object, member, 0, cache);
 		if (info == ZEND_WRONG_PROPERTY_INFO) {
 			rv = &EG(uninitialized_zval);
 		} else if (info == NULL || (info->flags & ZEND_ACC_STATIC) != 0) { //dynamic property
@@ -92,7 +114,7 @@ zval* pthreads_read_property(PTHREADS_READ_PROPERTY_PASSTHRU_D) {
 		} else {
 			//defined property, use mangled name
 			ZVAL_STR(&zmember, info->name);
-			pthreads_store_read(object, &zmember, type, rv);
+			pthreads_store_read_ex(object, &zmember, OBJ_PROP_TO_NUM(info->offset), type, rv);
 
 			if (Z_ISUNDEF_P(rv)) {
 				if (type != BP_VAR_IS) {
@@ -137,10 +159,12 @@ zval* pthreads_write_property(PTHREADS_WRITE_PROPERTY_PASSTHRU_D) {
 			zval_dtor(&rv);
 	} else {
 		bool ok = true;
-		zend_property_info* info = zend_get_property_info(object->ce, member, 0);
+		uint32_t slot = PTHREADS_STORE_NO_SLOT;
+		zend_property_info* info = pthreads_get_property_info_cached(object, member, 0, cache);
 		if (info != ZEND_WRONG_PROPERTY_INFO) {
 			if (info != NULL && (info->flags & ZEND_ACC_STATIC) == 0) {
 				ZVAL_STR(&zmember, info->name); //use mangled name to avoid private member shadowing issues
+				slot = OBJ_PROP_TO_NUM(info->offset);
 
 				zend_execute_data* execute_data = EG(current_execute_data);
 				bool strict = execute_data
@@ -152,7 +176,7 @@ zval* pthreads_write_property(PTHREADS_WRITE_PROPERTY_PASSTHRU_D) {
 				}
 			}
 
-			if (ok && pthreads_store_write(object, &zmember, value, PTHREADS_STORE_NO_COERCE_ARRAY) == FAILURE) {
+			if (ok && pthreads_store_write_ex(object, &zmember, slot, value, PTHREADS_STORE_NO_COERCE_ARRAY) == FAILURE) {
 				zend_throw_error(
 					NULL,
 					"Cannot assign non-thread-safe value of type %s to Threaded class property %s::$%s",
@@ -193,12 +217,14 @@ int pthreads_has_property(PTHREADS_HAS_PROPERTY_PASSTHRU_D) {
 			zval_dtor(&rv);
 		}
 	} else {
-		zend_property_info* info = zend_get_property_info(object->ce, member, 1);
+		uint32_t slot = PTHREADS_STORE_NO_SLOT;
+		zend_property_info* info = pthreads_get_property_info_cached(object, member, 1, cache);
 		if (info != ZEND_WRONG_PROPERTY_INFO) {
 			if (info != NULL && (info->flags & ZEND_ACC_STATIC) == 0) {
 				ZVAL_STR(&zmember, info->name); //defined property, use mangled name
+				slot = OBJ_PROP_TO_NUM(info->offset);
 			}
-			isset = pthreads_store_isset(object, &zmember, has_set_exists);
+			isset = pthreads_store_isset_ex(object, &zmember, slot, has_set_exists);
 		} else isset = 0;
 	}
 	return isset;
@@ -228,12 +254,14 @@ void pthreads_unset_property(PTHREADS_UNSET_PROPERTY_PASSTHRU_D) {
 			zval_dtor(&rv);
 		}
 	} else {
-		zend_property_info* info = zend_get_property_info(object->ce, member, 0);
+		uint32_t slot = PTHREADS_STORE_NO_SLOT;
+		zend_property_info* info = pthreads_get_property_info_cached(object, member, 0, cache);
 		if (info != ZEND_WRONG_PROPERTY_INFO) {
 			if (info != NULL && (info->flags & ZEND_ACC_STATIC) == 0) {
 				ZVAL_STR(&zmember, info->name); //defined property, use mangled name
+				slot = OBJ_PROP_TO_NUM(info->offset);
 			}
-			pthreads_store_delete(object, &zmember);
+			pthreads_store_delete_ex(object, &zmember, slot);
 		}
 	}
 }
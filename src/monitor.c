@@ -18,85 +18,724 @@
 
 #include <src/pthreads.h>
 #include <src/monitor.h>
+#include <src/atomic.h>
+#include <sched.h>
+#include <errno.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
-zend_result pthreads_monitor_init(pthreads_monitor_t* m) {
-	pthread_mutexattr_t at;
+#ifdef PTHREADS_MONITOR_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <limits.h>
+#endif
 
-	m->state = 0;
+/* {{{ every waiting thread queues one of these on the monitor, on its own stack; notifiers unlink the waiters they wake
+	while holding the lock, so a waiter which is still linked after waking has timed out */
+struct _pthreads_monitor_waiter_t {
+	pthreads_monitor_waiter_t *next;
+	pthreads_monitor_queue_t  queue;
+	zend_string               *key; //owned by the waiting thread, which outlives the wait
+	zend_ulong                hash;
+	volatile uint32_t         signalled;
+#ifndef PTHREADS_MONITOR_FUTEX
+	pthread_cond_t            cond;
+#endif
+}; /* }}} */
+
+/* {{{ the lock isn't recursive by itself, recursion is counted by the owner */
+static zend_always_inline zend_bool pthreads_monitor_is_owner(pthreads_monitor_t *m) {
+	/* owner can only ever equal us if we wrote it ourselves, and still hold the lock */
+	return m->depth > 0 && pthread_equal(m->owner, pthread_self());
+} /* }}} */
+
+/* {{{ */
+static zend_always_inline void pthreads_monitor_set_owner(pthreads_monitor_t *m, unsigned int depth) {
+	m->owner = pthread_self();
+	m->depth = depth;
+} /* }}} */
+
+/* {{{ returns the depth to restore with pthreads_monitor_set_owner() */
+static zend_always_inline unsigned int pthreads_monitor_clear_owner(pthreads_monitor_t *m) {
+	unsigned int depth = m->depth;
+
+	m->depth = 0;
+	memset((void*) &m->owner, 0, sizeof(pthread_t));
+
+	return depth;
+} /* }}} */
+
+#ifdef PTHREADS_MONITOR_FUTEX
+
+/* {{{ */
+static zend_always_inline long pthreads_futex(volatile uint32_t *word, int op, uint32_t value, const struct timespec *timeout) {
+	//monitors are never shared between processes, so the cheaper private futexes will do
+	return syscall(SYS_futex, word, op | FUTEX_PRIVATE_FLAG, value, timeout, NULL, 0);
+} /* }}} */
+
+/* {{{ The lock word is the three state mutex from Drepper's "Futexes Are Tricky": the uncontended paths are a
+	single atomic operation, and unlocking only makes a system call when another thread may be sleeping */
+static void pthreads_monitor_acquire(pthreads_monitor_t *m) {
+	uint32_t state = 0;
+
+	if (pthreads_atomic_compare_exchange_u32(&m->lock, &state, 1)) {
+		return;
+	}
+
+	if (state != 2) {
+		state = pthreads_atomic_exchange_u32(&m->lock, 2);
+	}
+
+	while (state != 0) {
+		pthreads_futex(&m->lock, FUTEX_WAIT, 2, NULL);
+		state = pthreads_atomic_exchange_u32(&m->lock, 2);
+	}
+} /* }}} */
+
+/* {{{ */
+static void pthreads_monitor_release(pthreads_monitor_t *m) {
+	if (pthreads_atomic_exchange_u32(&m->lock, 0) == 2) {
+		pthreads_futex(&m->lock, FUTEX_WAKE, 1, NULL);
+	}
+} /* }}} */
+
+/* {{{ */
+static zend_result pthreads_monitor_mutex_init(pthreads_monitor_t *m) {
+	m->lock = 0;
+
+	return SUCCESS;
+} /* }}} */
+
+/* {{{ */
+static void pthreads_monitor_mutex_destroy(pthreads_monitor_t *m) {} /* }}} */
+
+/* {{{ */
+static int pthreads_monitor_mutex_trylock(pthreads_monitor_t *m) {
+	uint32_t state = 0;
+
+	if (pthreads_monitor_is_owner(m)) {
+		m->depth++;
+		return 0;
+	}
+
+	//only attempt the exchange when it may succeed, so that spinning threads don't keep stealing the cache line
+	if (pthreads_atomic_load_u32(&m->lock) != 0 || !pthreads_atomic_compare_exchange_u32(&m->lock, &state, 1)) {
+		return EBUSY;
+	}
+	pthreads_monitor_set_owner(m, 1);
+
+	return 0;
+} /* }}} */
+
+/* {{{ */
+static int pthreads_monitor_mutex_block(pthreads_monitor_t *m) {
+	pthreads_monitor_acquire(m);
+	pthreads_monitor_set_owner(m, 1);
+
+	return 0;
+} /* }}} */
+
+/* {{{ */
+static int pthreads_monitor_mutex_unlock(pthreads_monitor_t *m) {
+	if (!pthreads_monitor_is_owner(m)) {
+		return EPERM;
+	}
+
+	if (m->depth == 1) {
+		pthreads_monitor_clear_owner(m);
+		pthreads_monitor_release(m);
+	} else m->depth--;
+
+	return 0;
+} /* }}} */
+
+/* {{{ */
+static zend_always_inline zend_result pthreads_monitor_waiter_init(pthreads_monitor_waiter_t *waiter) {
+	return SUCCESS;
+} /* }}} */
+
+/* {{{ */
+static zend_always_inline void pthreads_monitor_waiter_destroy(pthreads_monitor_waiter_t *waiter) {} /* }}} */
+
+/* {{{ */
+static int pthreads_monitor_sleep(pthreads_monitor_t *m, pthreads_monitor_waiter_t *waiter, uint64_t timeout) {
+	struct timespec spec;
+	uint64_t deadline = 0;
+	unsigned int depth;
+	int result = 0;
+
+	if (timeout > 0) {
+		deadline = pthreads_monitor_clock_ns() + timeout;
+	}
+
+	depth = pthreads_monitor_clear_owner(m);
+	pthreads_monitor_release(m);
+
+	while (!pthreads_atomic_load_u32(&waiter->signalled)) {
+		if (deadline) {
+			uint64_t now = pthreads_monitor_clock_ns();
+
+			if (now >= deadline) {
+				result = ETIMEDOUT;
+				break;
+			}
+			//FUTEX_WAIT timeouts are relative, and measured against CLOCK_MONOTONIC
+			spec.tv_sec = (time_t) ((deadline - now) / PTHREADS_MONITOR_NS_PER_SEC);
+			spec.tv_nsec = (long) ((deadline - now) % PTHREADS_MONITOR_NS_PER_SEC);
+		}
+
+		//EAGAIN, EINTR and timeouts are all resolved by the next iteration
+		pthreads_futex(&waiter->signalled, FUTEX_WAIT, 0, deadline ? &spec : NULL);
+	}
+
+	pthreads_monitor_acquire(m);
+	pthreads_monitor_set_owner(m, depth);
 
-	pthread_mutexattr_init(&at);
-#if defined(PTHREAD_MUTEX_RECURSIVE) || defined(__FreeBSD__)
-	pthread_mutexattr_settype(&at, PTHREAD_MUTEX_RECURSIVE);
+	return result;
+} /* }}} */
+
+/* {{{ must be called with the lock held, which keeps the waiter from returning, and so its memory valid */
+static void pthreads_monitor_signal(pthreads_monitor_waiter_t *waiter) {
+	pthreads_atomic_store_u32(&waiter->signalled, 1);
+	pthreads_futex(&waiter->signalled, FUTEX_WAKE, 1, NULL);
+} /* }}} */
 #else
-	pthread_mutexattr_settype(&at, PTHREAD_MUTEX_RECURSIVE_NP);
+/* {{{ */
+static zend_result pthreads_monitor_mutex_init(pthreads_monitor_t *m) {
+	//recursion is counted by the owner, which is cheaper than a recursive mutex, and lets waits release every level
+	return pthread_mutex_init(&m->mutex, NULL) == 0 ? SUCCESS : FAILURE;
+} /* }}} */
+
+/* {{{ */
+static void pthreads_monitor_mutex_destroy(pthreads_monitor_t *m) {
+	pthread_mutex_destroy(&m->mutex);
+} /* }}} */
+
+/* {{{ */
+static int pthreads_monitor_mutex_trylock(pthreads_monitor_t *m) {
+	int result;
+
+	if (pthreads_monitor_is_owner(m)) {
+		m->depth++;
+		return 0;
+	}
+
+	result = pthread_mutex_trylock(&m->mutex);
+	if (result == 0) {
+		pthreads_monitor_set_owner(m, 1);
+	}
+
+	return result;
+} /* }}} */
+
+/* {{{ */
+static int pthreads_monitor_mutex_block(pthreads_monitor_t *m) {
+	int result = pthread_mutex_lock(&m->mutex);
+
+	if (result == 0) {
+		pthreads_monitor_set_owner(m, 1);
+	}
+
+	return result;
+} /* }}} */
+
+/* {{{ */
+static int pthreads_monitor_mutex_unlock(pthreads_monitor_t *m) {
+	if (!pthreads_monitor_is_owner(m)) {
+		return EPERM;
+	}
+
+	if (m->depth == 1) {
+		pthreads_monitor_clear_owner(m);
+		return pthread_mutex_unlock(&m->mutex);
+	}
+	m->depth--;
+
+	return 0;
+} /* }}} */
+
+static pthread_once_t pthreads_monitor_condattr_once = PTHREAD_ONCE_INIT;
+static pthread_condattr_t pthreads_monitor_condattr;
+
+/* {{{ */
+static void pthreads_monitor_condattr_init(void) {
+	pthread_condattr_init(&pthreads_monitor_condattr);
+#ifdef HAVE_PTHREAD_CONDATTR_SETCLOCK
+	//timed waits must not be cut short or stretched by changes to the system time
+	pthread_condattr_setclock(&pthreads_monitor_condattr, CLOCK_MONOTONIC);
 #endif
-	int ret = pthread_mutex_init(&m->mutex, &at);
-	pthread_mutexattr_destroy(&at);
-	if (ret != 0) {
-		free(m);
-		return FAILURE;
+} /* }}} */
+
+/* {{{ */
+static zend_result pthreads_monitor_waiter_init(pthreads_monitor_waiter_t *waiter) {
+	pthread_once(&pthreads_monitor_condattr_once, pthreads_monitor_condattr_init);
+
+	return pthread_cond_init(&waiter->cond, &pthreads_monitor_condattr) == 0 ? SUCCESS : FAILURE;
+} /* }}} */
+
+/* {{{ */
+static zend_always_inline void pthreads_monitor_waiter_destroy(pthreads_monitor_waiter_t *waiter) {
+	pthread_cond_destroy(&waiter->cond);
+} /* }}} */
+
+/* {{{ */
+static int pthreads_monitor_sleep(pthreads_monitor_t *m, pthreads_monitor_waiter_t *waiter, uint64_t timeout) {
+	struct timespec spec;
+	uint64_t deadline = 0;
+	unsigned int depth;
+	int result = 0;
+
+	if (timeout > 0) {
+#if defined(__APPLE__) || defined(HAVE_PTHREAD_CONDATTR_SETCLOCK)
+		deadline = pthreads_monitor_clock_ns() + timeout;
+#else
+		struct timeval time;
+
+		if (gettimeofday(&time, NULL) != 0) {
+			return -1;
+		}
+		deadline = ((uint64_t) time.tv_sec * PTHREADS_MONITOR_NS_PER_SEC) + ((uint64_t) time.tv_usec * 1000) + timeout;
+#endif
+		spec.tv_sec = (time_t) (deadline / PTHREADS_MONITOR_NS_PER_SEC);
+		spec.tv_nsec = (long) (deadline % PTHREADS_MONITOR_NS_PER_SEC);
+	}
+
+	depth = pthreads_monitor_clear_owner(m);
+	while (!waiter->signalled && result == 0) {
+		if (deadline == 0) {
+			result = pthread_cond_wait(&waiter->cond, &m->mutex);
+		} else {
+#if defined(__APPLE__)
+			//macOS can't create monotonic condition variables, but relative waits aren't affected by the system time
+			uint64_t now = pthreads_monitor_clock_ns();
+
+			if (now >= deadline) {
+				result = ETIMEDOUT;
+				break;
+			}
+			spec.tv_sec = (time_t) ((deadline - now) / PTHREADS_MONITOR_NS_PER_SEC);
+			spec.tv_nsec = (long) ((deadline - now) % PTHREADS_MONITOR_NS_PER_SEC);
+
+			result = pthread_cond_timedwait_relative_np(&waiter->cond, &m->mutex, &spec);
+#else
+			result = pthread_cond_timedwait(&waiter->cond, &m->mutex, &spec);
+#endif
+		}
 	}
+	pthreads_monitor_set_owner(m, depth);
+
+	return result;
+} /* }}} */
+
+/* {{{ must be called with the lock held */
+static void pthreads_monitor_signal(pthreads_monitor_waiter_t *waiter) {
+	waiter->signalled = 1;
+	pthread_cond_signal(&waiter->cond);
+} /* }}} */
+#endif
+
+static zend_long pthreads_monitor_spin_limit = PTHREADS_MONITOR_SPIN_DEFAULT;
+static pthreads_monitor_stats_t pthreads_monitor_stats;
+
+/* {{{ */
+static zend_always_inline void pthreads_monitor_cpu_relax(void) {
+#if defined(_MSC_VER)
+	YieldProcessor();
+#elif defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_ARCH) && __ARM_ARCH >= 7)
+	__asm__ __volatile__("yield");
+#endif
+} /* }}} */
 
-	if (pthread_cond_init(&m->cond, NULL) != 0) {
-		pthread_mutex_destroy(&m->mutex);
-		free(m);
+/* {{{ Almost every critical section is a handful of instructions, so the owner is likely to release the lock in
+	less time than it would take to sleep and be woken; the lock is retried with exponential backoff, then yielding
+	the CPU between attempts, before blocking.
+	Like glibc's adaptive mutexes, each monitor keeps a running average of the attempts it took, and spins for at most
+	about twice that, so monitors whose owners hold them for a long time stop wasting CPU on spinning */
+static int pthreads_monitor_mutex_lock_contended(pthreads_monitor_t *m) {
+	zend_long limit = pthreads_monitor_spin_limit;
+	zend_long attempts = 0;
+	uint32_t spins = m->spins;
+
+	pthreads_atomic_fetch_add_u64(&pthreads_monitor_stats.contended, 1);
+
+	if (limit > (zend_long) (spins * 2) + PTHREADS_MONITOR_SPIN_MIN) {
+		limit = (zend_long) (spins * 2) + PTHREADS_MONITOR_SPIN_MIN;
+	}
+
+	while (attempts < limit) {
+		if (attempts < PTHREADS_MONITOR_SPIN_BACKOFF_SHIFT) {
+			uint32_t pauses = 2u << attempts;
+
+			while (pauses--) {
+				pthreads_monitor_cpu_relax();
+			}
+		} else {
+			sched_yield();
+			pthreads_atomic_fetch_add_u64(&pthreads_monitor_stats.yields, 1);
+		}
+		attempts++;
+
+		if (pthreads_monitor_mutex_trylock(m) == 0) {
+			m->spins = (uint32_t) ((int64_t) spins + (attempts - (int64_t) spins) / 8);
+			pthreads_atomic_fetch_add_u64(&pthreads_monitor_stats.spun, 1);
+			return 0;
+		}
+	}
+
+	if (limit > 0) {
+		m->spins = (uint32_t) ((int64_t) spins + (attempts - (int64_t) spins) / 8);
+	}
+	pthreads_atomic_fetch_add_u64(&pthreads_monitor_stats.blocked, 1);
+
+	return pthreads_monitor_mutex_block(m);
+} /* }}} */
+
+/* {{{ */
+static zend_always_inline int pthreads_monitor_mutex_lock(pthreads_monitor_t *m) {
+	int result = pthreads_monitor_mutex_trylock(m);
+
+	if (result != EBUSY) {
+		return result;
+	}
+
+	return pthreads_monitor_mutex_lock_contended(m);
+} /* }}} */
+
+/* {{{ */
+void pthreads_monitor_set_spin_limit(zend_long limit) {
+#ifdef _SC_NPROCESSORS_ONLN
+	//on a single CPU the owner can't run while we spin, so spinning only delays blocking
+	if (sysconf(_SC_NPROCESSORS_ONLN) == 1) {
+		limit = 0;
+	}
+#endif
+	pthreads_monitor_spin_limit = limit;
+} /* }}} */
+
+/* {{{ */
+void pthreads_monitor_get_stats(pthreads_monitor_stats_t *stats) {
+	stats->contended = pthreads_atomic_load_u64(&pthreads_monitor_stats.contended);
+	stats->spun = pthreads_atomic_load_u64(&pthreads_monitor_stats.spun);
+	stats->blocked = pthreads_atomic_load_u64(&pthreads_monitor_stats.blocked);
+	stats->yields = pthreads_atomic_load_u64(&pthreads_monitor_stats.yields);
+} /* }}} */
+
+zend_result pthreads_monitor_init(pthreads_monitor_t* m) {
+	return pthreads_monitor_init_ex(m, 0);
+}
+
+zend_result pthreads_monitor_init_ex(pthreads_monitor_t* m, zend_ulong flags) {
+	m->state = 0;
+	m->spins = 0;
+	m->waiters = NULL;
+	m->depth = 0;
+	memset((void*) &m->owner, 0, sizeof(pthread_t));
+	m->rwlock = NULL;
+	m->rw_depth = 0;
+	memset((void*) &m->rw_owner, 0, sizeof(pthread_t));
+
+	if (pthreads_monitor_mutex_init(m) != SUCCESS) {
 		return FAILURE;
 	}
 
+	if (flags & PTHREADS_MONITOR_INIT_RWLOCK) {
+		m->rwlock = malloc(sizeof(pthread_rwlock_t));
+		if (m->rwlock == NULL || pthread_rwlock_init(m->rwlock, NULL) != 0) {
+			free(m->rwlock);
+			m->rwlock = NULL;
+			pthreads_monitor_mutex_destroy(m);
+			return FAILURE;
+		}
+	}
+
 	return SUCCESS;
 }
 
 void pthreads_monitor_destroy(pthreads_monitor_t* m) {
-	pthread_mutex_destroy(&m->mutex);
-	pthread_cond_destroy(&m->cond);
+	pthreads_monitor_mutex_destroy(m);
+	if (m->rwlock) {
+		pthread_rwlock_destroy(m->rwlock);
+		free(m->rwlock);
+		m->rwlock = NULL;
+	}
 }
 
+/* {{{ In read/write mode, the exclusive lock is the mutex plus the write side of the rwlock.
+	The mutex is always taken first, so that exclusive lockers queue on it rather than on the rwlock,
+	and the write side is only taken by the outermost exclusive lock of the owning thread */
 zend_bool pthreads_monitor_lock(pthreads_monitor_t *m) {
-	return (pthread_mutex_lock(&m->mutex) == 0);
-}
+	if (pthreads_monitor_mutex_lock(m) != 0) {
+		return 0;
+	}
+
+	if (m->rwlock) {
+		if (m->rw_depth == 0) {
+			if (pthread_rwlock_wrlock(m->rwlock) != 0) {
+				pthreads_monitor_mutex_unlock(m);
+				return 0;
+			}
+			m->rw_owner = pthread_self();
+		}
+		m->rw_depth++;
+	}
+
+	return 1;
+} /* }}} */
 
+/* {{{ */
 zend_bool pthreads_monitor_unlock(pthreads_monitor_t *m) {
-	return (pthread_mutex_unlock(&m->mutex) == 0);
+	if (m->rwlock && --m->rw_depth == 0) {
+		memset((void*) &m->rw_owner, 0, sizeof(pthread_t));
+		pthread_rwlock_unlock(m->rwlock);
+	}
+
+	return (pthreads_monitor_mutex_unlock(m) == 0);
+} /* }}} */
+
+/* {{{ */
+static zend_always_inline zend_bool pthreads_monitor_is_exclusive_owner(pthreads_monitor_t *m) {
+	/* rw_owner can only ever equal us if we wrote it ourselves, and still hold the exclusive lock */
+	return m->rw_depth > 0 && pthread_equal(m->rw_owner, pthread_self());
+} /* }}} */
+
+#if ZEND_DEBUG
+/* {{{ the read sides held by the calling thread, so that debug builds can catch notifications made under them */
+#define PTHREADS_MONITOR_SHARED_TRACKED 16 //further read sides held at once just aren't tracked
+
+ZEND_TLS pthreads_monitor_t *pthreads_monitor_shared_held[PTHREADS_MONITOR_SHARED_TRACKED];
+ZEND_TLS uint32_t pthreads_monitor_shared_held_count;
+
+static void pthreads_monitor_track_shared(pthreads_monitor_t *m) {
+	if (pthreads_monitor_shared_held_count < PTHREADS_MONITOR_SHARED_TRACKED) {
+		pthreads_monitor_shared_held[pthreads_monitor_shared_held_count] = m;
+	}
+	pthreads_monitor_shared_held_count++;
 }
 
+static void pthreads_monitor_untrack_shared(pthreads_monitor_t *m) {
+	uint32_t index = MIN(pthreads_monitor_shared_held_count, PTHREADS_MONITOR_SHARED_TRACKED);
+
+	while (index-- > 0) {
+		if (pthreads_monitor_shared_held[index] == m) {
+			//order doesn't matter, so the last entry can fill the hole
+			pthreads_monitor_shared_held[index] =
+				pthreads_monitor_shared_held[MIN(pthreads_monitor_shared_held_count, PTHREADS_MONITOR_SHARED_TRACKED) - 1];
+			break;
+		}
+	}
+	pthreads_monitor_shared_held_count--;
+}
+
+static zend_bool pthreads_monitor_holds_shared(pthreads_monitor_t *m) {
+	uint32_t index = MIN(pthreads_monitor_shared_held_count, PTHREADS_MONITOR_SHARED_TRACKED);
+
+	while (index-- > 0) {
+		if (pthreads_monitor_shared_held[index] == m) {
+			return 1;
+		}
+	}
+	return 0;
+} /* }}} */
+#endif
+
+/* {{{ Acquires the monitor for reading; on monitors without a rwlock, this is the same as pthreads_monitor_lock
+	If the calling thread already holds the exclusive lock, the lock is taken recursively instead */
+zend_bool pthreads_monitor_lock_shared(pthreads_monitor_t *m) {
+	if (m->rwlock == NULL || pthreads_monitor_is_exclusive_owner(m)) {
+		return pthreads_monitor_lock(m);
+	}
+
+	if (pthread_rwlock_rdlock(m->rwlock) != 0) {
+		return 0;
+	}
+#if ZEND_DEBUG
+	pthreads_monitor_track_shared(m);
+#endif
+
+	return 1;
+} /* }}} */
+
+/* {{{ */
+zend_bool pthreads_monitor_unlock_shared(pthreads_monitor_t *m) {
+	if (m->rwlock == NULL || pthreads_monitor_is_exclusive_owner(m)) {
+		return pthreads_monitor_unlock(m);
+	}
+
+#if ZEND_DEBUG
+	pthreads_monitor_untrack_shared(m);
+#endif
+	return (pthread_rwlock_unlock(m->rwlock) == 0);
+} /* }}} */
+
 pthreads_monitor_state_t pthreads_monitor_check(pthreads_monitor_t *m, pthreads_monitor_state_t state) {
 	return (m->state & state);
 }
 
-int pthreads_monitor_wait(pthreads_monitor_t *m, long timeout) {
+/* {{{ */
+uint64_t pthreads_monitor_clock_ns(void) {
+#if defined(CLOCK_MONOTONIC) && !defined(_WIN32)
+	struct timespec now;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &now) == 0) {
+		return ((uint64_t) now.tv_sec * PTHREADS_MONITOR_NS_PER_SEC) + (uint64_t) now.tv_nsec;
+	}
+#endif
 	struct timeval time;
-	struct timespec spec;
 
-	if (timeout == 0) {
-		return pthread_cond_wait(&m->cond, &m->mutex);
+	gettimeofday(&time, NULL);
+	return ((uint64_t) time.tv_sec * PTHREADS_MONITOR_NS_PER_SEC) + ((uint64_t) time.tv_usec * 1000);
+} /* }}} */
+
+/* {{{ */
+static zend_always_inline zend_bool pthreads_monitor_waiter_matches(pthreads_monitor_waiter_t *waiter, pthreads_monitor_queue_t queue, zend_string *key, zend_ulong hash) {
+	if (waiter->queue != queue) {
+		return 0;
+	}
+	if (key == NULL || waiter->key == NULL) {
+		return key == waiter->key;
 	}
+	//the key belongs to another thread, so it mustn't be hashed or otherwise modified here
+	return waiter->hash == hash && zend_string_equal_content(waiter->key, key);
+} /* }}} */
 
-	if (gettimeofday(&time, NULL) != 0) {
+/* {{{ */
+static int pthreads_monitor_wait_queue(pthreads_monitor_t *m, uint64_t timeout, pthreads_monitor_queue_t queue, zend_string *key) {
+	pthreads_monitor_waiter_t waiter, **link;
+	int result;
+
+	//every level of a recursively held lock is released for the duration of the wait
+	if (!pthreads_monitor_is_owner(m)) {
+		return EPERM;
+	}
+
+	waiter.next = NULL;
+	waiter.queue = queue;
+	waiter.key = key;
+	waiter.hash = key ? ZSTR_HASH(key) : 0;
+	waiter.signalled = 0;
+	if (pthreads_monitor_waiter_init(&waiter) != SUCCESS) {
 		return -1;
 	}
 
-	time.tv_sec += (timeout / 1000000L);
-	time.tv_sec += (time.tv_usec + (timeout % 1000000L)) / 1000000L;
-	time.tv_usec = (time.tv_usec + (timeout % 1000000L)) % 1000000L;
+	//waiters are woken in the order they started waiting
+	for (link = &m->waiters; *link; link = &(*link)->next);
+	*link = &waiter;
 
-	spec.tv_sec = time.tv_sec;
-	spec.tv_nsec = time.tv_usec * 1000;
+	result = pthreads_monitor_sleep(m, &waiter, timeout);
 
-	return pthread_cond_timedwait(&m->cond, &m->mutex, &spec);
-}
+	if (waiter.signalled) {
+		result = 0;
+	} else {
+		for (link = &m->waiters; *link != &waiter; link = &(*link)->next);
+		*link = waiter.next;
+	}
+	pthreads_monitor_waiter_destroy(&waiter);
+
+	return result;
+} /* }}} */
+
+/* {{{ */
+int pthreads_monitor_wait(pthreads_monitor_t *m, long timeout) {
+	if (timeout < 0) {
+		return ETIMEDOUT;
+	}
+	if ((uint64_t) timeout > PTHREADS_MONITOR_WAIT_MAX / 1000) {
+		return pthreads_monitor_wait_ns(m, PTHREADS_MONITOR_WAIT_MAX);
+	}
+
+	return pthreads_monitor_wait_ns(m, (uint64_t) timeout * 1000);
+} /* }}} */
+
+/* {{{ */
+int pthreads_monitor_wait_ns(pthreads_monitor_t *m, uint64_t timeout) {
+	return pthreads_monitor_wait_ex(m, timeout, PTHREADS_MONITOR_QUEUE_USER, NULL);
+} /* }}} */
+
+/* {{{ */
+int pthreads_monitor_wait_ex(pthreads_monitor_t *m, uint64_t timeout, pthreads_monitor_queue_t queue, zend_string *key) {
+	int result;
+	unsigned int depth;
+
+	if (timeout > PTHREADS_MONITOR_WAIT_MAX) {
+		timeout = PTHREADS_MONITOR_WAIT_MAX;
+	}
+
+	if (m->rwlock == NULL || !pthreads_monitor_is_exclusive_owner(m)) {
+		return pthreads_monitor_wait_queue(m, timeout, queue, key);
+	}
+
+	/* readers and writers must be able to get in while we're waiting, so the write side is released for the
+		duration of the wait; it's reacquired while holding the mutex, which preserves the lock order */
+	depth = m->rw_depth;
+	m->rw_depth = 0;
+	memset((void*) &m->rw_owner, 0, sizeof(pthread_t));
+	pthread_rwlock_unlock(m->rwlock);
+
+	result = pthreads_monitor_wait_queue(m, timeout, queue, key);
+
+	pthread_rwlock_wrlock(m->rwlock);
+	m->rw_owner = pthread_self();
+	m->rw_depth = depth;
+
+	return result;
+} /* }}} */
+
+/* {{{ The waiter list is guarded by the mutex, so this may be called while holding the monitor exclusively, or not
+	at all, but never while holding only the read side of a rwlock monitor: exclusive lockers take the write side while
+	holding the mutex, so one of them waiting for our read side to be released would never release the mutex to us */
+int pthreads_monitor_notify_ex(pthreads_monitor_t *m, pthreads_monitor_queue_t queue, zend_string *key, zend_bool all) {
+	pthreads_monitor_waiter_t **link;
+	zend_ulong hash = key ? ZSTR_HASH(key) : 0;
+
+#if ZEND_DEBUG
+	ZEND_ASSERT(!pthreads_monitor_holds_shared(m));
+#endif
+
+	//a notification racing with a thread which isn't waiting yet would be missed anyway
+	if (*(pthreads_monitor_waiter_t *volatile *) &m->waiters == NULL) {
+		return 0;
+	}
+
+	if (pthreads_monitor_mutex_lock(m) != 0) {
+		return -1;
+	}
+
+	link = &m->waiters;
+	while (*link) {
+		pthreads_monitor_waiter_t *waiter = *link;
+
+		if (!pthreads_monitor_waiter_matches(waiter, queue, key, hash)) {
+			link = &waiter->next;
+			continue;
+		}
+
+		*link = waiter->next;
+		pthreads_monitor_signal(waiter);
+		if (!all) {
+			break;
+		}
+	}
+
+	pthreads_monitor_mutex_unlock(m);
+
+	return 0;
+} /* }}} */
 
 int pthreads_monitor_notify(pthreads_monitor_t *m) {
-	return pthread_cond_broadcast(&m->cond);
+	return pthreads_monitor_notify_ex(m, PTHREADS_MONITOR_QUEUE_USER, NULL, 1);
 }
 
 int pthreads_monitor_notify_one(pthreads_monitor_t *m) {
-	return pthread_cond_signal(&m->cond);
+	return pthreads_monitor_notify_ex(m, PTHREADS_MONITOR_QUEUE_USER, NULL, 0);
 }
 
 void pthreads_monitor_wait_until(pthreads_monitor_t *m, pthreads_monitor_state_t state) {
 	if (pthreads_monitor_lock(m)) {
 		while (!pthreads_monitor_check(m, state)) {
-			if (pthreads_monitor_wait(m, 0) != 0) {
+			if (pthreads_monitor_wait_ex(m, 0, PTHREADS_MONITOR_QUEUE_STATE, NULL) != 0) {
 				break;
 			}
 		}
@@ -107,7 +746,7 @@ void pthreads_monitor_wait_until(pthreads_monitor_t *m, pthreads_monitor_state_t
 void pthreads_monitor_add(pthreads_monitor_t *m, pthreads_monitor_state_t state) {
 	if (pthreads_monitor_lock(m)) {
 		m->state |= state;
-		pthreads_monitor_notify(m);
+		pthreads_monitor_notify_ex(m, PTHREADS_MONITOR_QUEUE_STATE, NULL, 1);
 		pthreads_monitor_unlock(m);
 	}
 }
@@ -115,7 +754,7 @@ void pthreads_monitor_add(pthreads_monitor_t *m, pthreads_monitor_state_t state)
 void pthreads_monitor_remove(pthreads_monitor_t *m, pthreads_monitor_state_t state) {
 	if (pthreads_monitor_lock(m)) {
 		m->state &= ~state;
-		pthreads_monitor_notify(m);
+		pthreads_monitor_notify_ex(m, PTHREADS_MONITOR_QUEUE_STATE, NULL, 1);
 		pthreads_monitor_unlock(m);
 	}
 }
@@ -20,12 +20,56 @@
 
 typedef unsigned long pthreads_monitor_state_t;
 
+/* {{{ waits and notifications only meet on the same queue, so that notifications only wake the threads they concern */
+typedef enum _pthreads_monitor_queue_t {
+	PTHREADS_MONITOR_QUEUE_USER, //ThreadedBase::wait() and notify(); keyed waits are only woken by notifications for the same key
+	PTHREADS_MONITOR_QUEUE_STATE, //changes to the monitor state, and new tasks for Worker threads
+	PTHREADS_MONITOR_QUEUE_ITEMS, //items pushed to a ThreadedQueue
+	PTHREADS_MONITOR_QUEUE_MEMBERS, //changes to the members of a ThreadedBase, for ThreadedBase::waitUntil() and friends
+} pthreads_monitor_queue_t; /* }}} */
+
+typedef struct _pthreads_monitor_waiter_t pthreads_monitor_waiter_t;
+
 typedef struct _pthreads_monitor_t {
 	volatile pthreads_monitor_state_t state;
+#ifdef PTHREADS_MONITOR_FUTEX
+	volatile uint32_t        lock; //0 = unlocked, 1 = locked, 2 = locked and other threads may be sleeping on it
+#else
 	pthread_mutex_t          mutex;
-	pthread_cond_t           cond;
+#endif
+	volatile pthread_t       owner;
+	unsigned int             depth; //the lock is recursive, but the mutex isn't
+	pthreads_monitor_waiter_t *waiters; //threads waiting for notification, oldest first; guarded by the mutex
+	pthread_rwlock_t         *rwlock; //NULL unless the monitor was created with PTHREADS_MONITOR_INIT_RWLOCK
+	volatile pthread_t       rw_owner;
+	unsigned int             rw_depth;
+	volatile uint32_t        spins; //running average of the attempts contended acquisitions took, see pthreads_monitor_lock()
 } pthreads_monitor_t;
 
+/* {{{ timed waits are measured in nanoseconds against a monotonic clock where the platform allows it, so that changes
+	to the system time don't cut them short or stretch them; pthreads_monitor_wait() takes microseconds, and waits
+	which time out return ETIMEDOUT */
+#define PTHREADS_MONITOR_NS_PER_SEC  1000000000ULL
+#define PTHREADS_MONITOR_WAIT_MAX    (PTHREADS_MONITOR_NS_PER_SEC * 60 * 60 * 24 * 365 * 100) //longer timeouts are clamped to this
+/* }}} */
+
+/* {{{ contended acquisitions retry up to pthreads.monitor_spin times before blocking; the first few attempts back off
+	exponentially, the rest yield the CPU */
+#define PTHREADS_MONITOR_SPIN_DEFAULT        100
+#define PTHREADS_MONITOR_SPIN_MIN            10 //attempts allowed regardless of a monitor's average
+#define PTHREADS_MONITOR_SPIN_BACKOFF_SHIFT  6 //attempts which pause rather than yield; the last pauses 64 times
+/* }}} */
+
+/* {{{ process-wide counters, only updated on contention; contended = spun + blocked */
+typedef struct _pthreads_monitor_stats_t {
+	uint64_t contended; //acquisitions which found the lock held by another thread
+	uint64_t spun; //contended acquisitions which got the lock by retrying
+	uint64_t blocked; //contended acquisitions which had to sleep
+	uint64_t yields; //sched_yield() calls made while retrying
+} pthreads_monitor_stats_t; /* }}} */
+
+#define PTHREADS_MONITOR_INIT_RWLOCK     (1<<0)
+
 #define PTHREADS_MONITOR_NOTHING         (0)
 #define PTHREADS_MONITOR_STARTED         (1<<0)
 #define PTHREADS_MONITOR_RUNNING         (1<<1)
@@ -37,14 +81,23 @@ typedef struct _pthreads_monitor_t {
 #define PTHREADS_MONITOR_AWAIT_JOIN      (1<<7)
 
 zend_result pthreads_monitor_init(pthreads_monitor_t* m);
+zend_result pthreads_monitor_init_ex(pthreads_monitor_t* m, zend_ulong flags);
 void pthreads_monitor_destroy(pthreads_monitor_t* m);
 zend_bool pthreads_monitor_lock(pthreads_monitor_t *m);
 zend_bool pthreads_monitor_unlock(pthreads_monitor_t *m);
+zend_bool pthreads_monitor_lock_shared(pthreads_monitor_t *m);
+zend_bool pthreads_monitor_unlock_shared(pthreads_monitor_t *m);
 pthreads_monitor_state_t pthreads_monitor_check(pthreads_monitor_t *m, pthreads_monitor_state_t state);
 int pthreads_monitor_wait(pthreads_monitor_t *m, long timeout);
+int pthreads_monitor_wait_ns(pthreads_monitor_t *m, uint64_t timeout);
+int pthreads_monitor_wait_ex(pthreads_monitor_t *m, uint64_t timeout, pthreads_monitor_queue_t queue, zend_string *key);
+uint64_t pthreads_monitor_clock_ns(void);
 int pthreads_monitor_notify(pthreads_monitor_t *m);
 int pthreads_monitor_notify_one(pthreads_monitor_t *m);
+int pthreads_monitor_notify_ex(pthreads_monitor_t *m, pthreads_monitor_queue_t queue, zend_string *key, zend_bool all);
 void pthreads_monitor_wait_until(pthreads_monitor_t *m, pthreads_monitor_state_t state);
 void pthreads_monitor_add(pthreads_monitor_t *m, pthreads_monitor_state_t state);
 void pthreads_monitor_remove(pthreads_monitor_t *m, pthreads_monitor_state_t state);
+void pthreads_monitor_set_spin_limit(zend_long limit);
+void pthreads_monitor_get_stats(pthreads_monitor_stats_t *stats);
 #endif
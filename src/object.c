@@ -184,6 +184,18 @@ zend_object* pthreads_threaded_array_ctor(zend_class_entry *entry) {
 	return &threaded->std;
 } /* }}} */
 
+/* {{{ */
+zend_object* pthreads_threaded_queue_ctor(zend_class_entry *entry) {
+	pthreads_zend_object_t* threaded = pthreads_globals_object_alloc(
+		sizeof(pthreads_zend_object_t) + zend_object_properties_size(entry));
+
+	pthreads_base_ctor(threaded, entry, PTHREADS_SCOPE_THREADED);
+	pthreads_store_init_ring(&threaded->ts_obj->props);
+	threaded->std.handlers = &pthreads_threaded_base_handlers;
+
+	return &threaded->std;
+} /* }}} */
+
 /* {{{ */
 int pthreads_threaded_serialize(zval *object, unsigned char **buffer, size_t *buflen, zend_serialize_data *data) {
 	pthreads_zend_object_t *address = PTHREADS_FETCH_FROM(Z_OBJ_P(object));
@@ -239,6 +251,14 @@ static inline int _pthreads_connect_nolock(pthreads_zend_object_t* source, pthre
 			destination->worker_data = NULL;
 		}
 
+		if (destination->local_scalar_cells) {
+			//cells belong to the store we're about to disconnect from
+			zend_hash_clean(destination->local_scalar_cells);
+		}
+		if (destination->local_props_serials) {
+			zend_hash_clean(destination->local_props_serials);
+		}
+
 		if (destination->ts_obj && --destination->ts_obj->refcount == 0) {
 			pthreads_ts_object_free(destination);
 		}
@@ -253,6 +273,7 @@ static inline int _pthreads_connect_nolock(pthreads_zend_object_t* source, pthre
 
 		if (destination->std.properties)
 			zend_hash_clean(destination->std.properties);
+		pthreads_store_invalidate_local_properties(&destination->std);
 
 		return SUCCESS;
 	} else return FAILURE;
@@ -331,8 +352,8 @@ static inline void pthreads_base_init(pthreads_zend_object_t* base) {
 
 			value = OBJ_PROP(&base->std, info->offset);
 			if (!Z_ISUNDEF_P(value)) {
-				result = pthreads_store_write(
-					&base->std, &key,
+				result = pthreads_store_write_ex(
+					&base->std, &key, OBJ_PROP_TO_NUM(info->offset),
 					value,
 					PTHREADS_STORE_NO_COERCE_ARRAY
 				);
@@ -355,29 +376,49 @@ static inline void pthreads_base_init(pthreads_zend_object_t* base) {
 } /* }}} */
 
 /* {{{ */
-static pthreads_object_t* pthreads_ts_object_ctor(unsigned int scope) {
-	pthreads_object_t* ts_obj = calloc(1, sizeof(pthreads_object_t));
+static zend_bool pthreads_class_uses_rwlock(zend_class_entry *ce) {
+	while (ce) {
+		if (ce->attributes && zend_get_attribute_str(ce->attributes, ZEND_STRL("threadedreadwritelock"))) {
+			return 1;
+		}
+		ce = ce->parent;
+	}
+	return 0;
+} /* }}} */
+
+/* {{{ both classes are final, so subclasses needn't be considered */
+static zend_bool pthreads_class_is_atomic(zend_class_entry *ce) {
+	return ce == pthreads_threaded_atomic_int_entry || ce == pthreads_threaded_atomic_float_entry;
+} /* }}} */
+
+/* {{{ */
+static pthreads_object_t* pthreads_ts_object_ctor(zend_class_entry *entry, unsigned int scope) {
+	pthreads_object_t* ts_obj = calloc(1,
+		pthreads_class_is_atomic(entry) ? sizeof(pthreads_atomic_object_t) : sizeof(pthreads_object_t));
 	ts_obj->scope = scope;
 	ts_obj->refcount = 1;
-	pthreads_monitor_init(&ts_obj->monitor);
+	pthreads_monitor_init_ex(&ts_obj->monitor, pthreads_class_uses_rwlock(entry) ? PTHREADS_MONITOR_INIT_RWLOCK : 0);
 	ts_obj->creator.ls = TSRMLS_CACHE;
 	ts_obj->creator.id = pthreads_self();
 	pthreads_store_init(&ts_obj->props);
+	pthreads_store_init_slots(&ts_obj->props, entry->default_properties_count);
 	return ts_obj;
 } /* }}} */
 
 /* {{{ */
 static void pthreads_base_ctor(pthreads_zend_object_t* base, zend_class_entry *entry, unsigned int scope) {
-	base->ts_obj = pthreads_ts_object_ctor(scope);
+	base->ts_obj = pthreads_ts_object_ctor(entry, scope);
 	base->owner.ls = TSRMLS_CACHE;
 	base->owner.id = pthreads_self();
 	base->original_zobj = NULL;
 	base->worker_data = NULL;
+	base->local_scalar_cells = NULL;
+	base->local_props_serials = NULL;
 
 	zend_object_std_init(&base->std, entry);
 	object_properties_init(&base->std, entry);
 	pthreads_base_init(base);
-	base->local_props_modcount = base->ts_obj->props.modcount - 1;
+	pthreads_store_invalidate_local_properties(&base->std);
 } /* }}} */
 
 /* {{{ */
@@ -420,6 +461,18 @@ void pthreads_base_free(zend_object *object) {
 		pthreads_worker_data_free(base->worker_data);
 	}
 
+	if (base->local_scalar_cells) {
+		zend_hash_destroy(base->local_scalar_cells);
+		FREE_HASHTABLE(base->local_scalar_cells);
+		base->local_scalar_cells = NULL;
+	}
+
+	if (base->local_props_serials) {
+		zend_hash_destroy(base->local_props_serials);
+		FREE_HASHTABLE(base->local_props_serials);
+		base->local_props_serials = NULL;
+	}
+
 	if (zend_hash_index_find_ptr(&PTHREADS_ZG(resolve), (zend_ulong)base->ts_obj) == base) {
 		/* this is the primary connection to the TS object on the current thread - destroy it */
 		zend_hash_index_del(&PTHREADS_ZG(resolve), (zend_ulong)base->ts_obj);
@@ -27,6 +27,7 @@
 /* {{{ */
 zend_object* pthreads_threaded_base_ctor(zend_class_entry *entry);
 zend_object* pthreads_threaded_array_ctor(zend_class_entry *entry);
+zend_object* pthreads_threaded_queue_ctor(zend_class_entry *entry);
 zend_object* pthreads_worker_ctor(zend_class_entry *entry);
 zend_object* pthreads_thread_ctor(zend_class_entry *entry);
 void         pthreads_base_dtor(zend_object *object);
@@ -54,12 +54,14 @@
 #include <ext/standard/info.h>
 #include <ext/standard/basic_functions.h>
 #include <ext/standard/php_var.h>
+#include <ext/spl/spl_array.h>
 #include <ext/spl/spl_exceptions.h>
 #include <ext/spl/spl_iterators.h>
 #if HAVE_PTHREADS_EXT_SOCKETS_SUPPORT
 #include <ext/sockets/php_sockets.h>
 #endif
 #include <Zend/zend.h>
+#include <Zend/zend_attributes.h>
 #include <Zend/zend_closures.h>
 #include <Zend/zend_compile.h>
 #include <Zend/zend_exceptions.h>
@@ -76,16 +78,22 @@
 #include <Zend/zend_vm.h>
 #include <TSRM/TSRM.h>
 
+#include <src/slab.h>
+
 #ifdef DMALLOC
 #include <dmalloc.h>
 #endif
 
 extern zend_class_entry *pthreads_threaded_base_entry;
 extern zend_class_entry *pthreads_threaded_array_entry;
+extern zend_class_entry *pthreads_threaded_queue_entry;
+extern zend_class_entry *pthreads_threaded_atomic_int_entry;
+extern zend_class_entry *pthreads_threaded_atomic_float_entry;
 extern zend_class_entry *pthreads_threaded_runnable_entry;
 extern zend_class_entry *pthreads_thread_entry;
 extern zend_class_entry *pthreads_worker_entry;
 extern zend_class_entry *pthreads_ce_ThreadedConnectionException;
+extern zend_class_entry *pthreads_ce_ThreadedReadWriteLock;
 
 #define IS_PTHREADS_CLASS(c) \
 	(instanceof_function(c, pthreads_threaded_base_entry))
@@ -124,6 +132,7 @@ ZEND_BEGIN_MODULE_GLOBALS(pthreads)
 	HashTable filenames;
 	HashTable *resources;
 	int hard_copy_interned_strings;
+	pthreads_slab_cache_t slab_cache;
 #if HAVE_PTHREADS_EXT_SOCKETS_SUPPORT
 	zend_object_handlers *original_socket_object_handlers;
 	zend_object_handlers custom_socket_object_handlers;
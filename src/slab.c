@@ -0,0 +1,204 @@
+/*
+  +----------------------------------------------------------------------+
+  | pthreads                                                             |
+  +----------------------------------------------------------------------+
+  | Copyright (c) Joe Watkins 2012 - 2015                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Joe Watkins <krakjoe@php.net>                                |
+  +----------------------------------------------------------------------+
+ */
+
+#include <src/pthreads.h>
+#include <src/slab.h>
+
+/* {{{ header of each slab, followed by its blocks; slabs are only released at shutdown */
+typedef struct _pthreads_slab_t {
+	struct _pthreads_slab_t *next;
+} pthreads_slab_t; /* }}} */
+
+#define PTHREADS_SLAB_CLASS(size) (((size) - 1) / PTHREADS_SLAB_ALIGNMENT)
+#define PTHREADS_SLAB_CLASS_SIZE(size_class) (((size_class) + 1) * PTHREADS_SLAB_ALIGNMENT)
+#define PTHREADS_SLAB_HEADER_SIZE ZEND_MM_ALIGNED_SIZE_EX(sizeof(pthreads_slab_t), PTHREADS_SLAB_ALIGNMENT)
+
+/* {{{ blocks returned by threads whose caches are full, shared by all threads */
+static struct _pthreads_slab_depot_t {
+	pthread_mutex_t mutex;
+	pthreads_slab_block_t *blocks[PTHREADS_SLAB_CLASSES];
+	uint32_t count[PTHREADS_SLAB_CLASSES];
+	pthreads_slab_t *slabs;
+	pthreads_slab_stats_t stats;
+} pthreads_slab_depot; /* }}} */
+
+/* {{{ */
+zend_result pthreads_slab_init(void) {
+	memset(&pthreads_slab_depot, 0, sizeof(pthreads_slab_depot));
+	if (pthread_mutex_init(&pthreads_slab_depot.mutex, NULL) != 0) {
+		return FAILURE;
+	}
+	return SUCCESS;
+} /* }}} */
+
+/* {{{ */
+void pthreads_slab_shutdown(void) {
+	pthreads_slab_t *slab = pthreads_slab_depot.slabs;
+
+	while (slab != NULL) {
+		pthreads_slab_t *next = slab->next;
+		free(slab);
+		slab = next;
+	}
+	pthreads_slab_depot.slabs = NULL;
+	pthread_mutex_destroy(&pthreads_slab_depot.mutex);
+} /* }}} */
+
+/* {{{ Must be called with the depot locked */
+static zend_always_inline void pthreads_slab_collect_stats(pthreads_slab_cache_t *cache) {
+	pthreads_slab_depot.stats.allocations += cache->stats.allocations;
+	pthreads_slab_depot.stats.cache_hits += cache->stats.cache_hits;
+	pthreads_slab_depot.stats.oversized += cache->stats.oversized;
+	memset(&cache->stats, 0, sizeof(pthreads_slab_stats_t));
+} /* }}} */
+
+/* {{{ Moves up to count blocks from one list to another, returns the number moved */
+static zend_always_inline uint32_t pthreads_slab_move(pthreads_slab_block_t **from, pthreads_slab_block_t **to, uint32_t count) {
+	uint32_t moved = 0;
+
+	while (moved < count && *from != NULL) {
+		pthreads_slab_block_t *block = *from;
+		*from = block->next;
+		block->next = *to;
+		*to = block;
+		moved++;
+	}
+	return moved;
+} /* }}} */
+
+/* {{{ Carves a new slab into blocks in the depot; must be called with the depot locked */
+static zend_bool pthreads_slab_grow(uint32_t size_class) {
+	size_t size = PTHREADS_SLAB_CLASS_SIZE(size_class);
+	pthreads_slab_t *slab = malloc(PTHREADS_SLAB_HEADER_SIZE + (size * PTHREADS_SLAB_BLOCKS));
+	char *blocks;
+
+	if (slab == NULL) {
+		return 0;
+	}
+	slab->next = pthreads_slab_depot.slabs;
+	pthreads_slab_depot.slabs = slab;
+
+	blocks = ((char*) slab) + PTHREADS_SLAB_HEADER_SIZE;
+	for (uint32_t i = 0; i < PTHREADS_SLAB_BLOCKS; i++) {
+		pthreads_slab_block_t *block = (pthreads_slab_block_t*) (blocks + (size * i));
+		block->next = pthreads_slab_depot.blocks[size_class];
+		pthreads_slab_depot.blocks[size_class] = block;
+	}
+	pthreads_slab_depot.count[size_class] += PTHREADS_SLAB_BLOCKS;
+	pthreads_slab_depot.stats.slabs++;
+	return 1;
+} /* }}} */
+
+/* {{{ */
+static zend_bool pthreads_slab_refill(pthreads_slab_cache_t *cache, uint32_t size_class) {
+	uint32_t moved;
+
+	pthread_mutex_lock(&pthreads_slab_depot.mutex);
+	pthreads_slab_collect_stats(cache);
+	if (pthreads_slab_depot.blocks[size_class] == NULL && !pthreads_slab_grow(size_class)) {
+		pthread_mutex_unlock(&pthreads_slab_depot.mutex);
+		return 0;
+	}
+	moved = pthreads_slab_move(&pthreads_slab_depot.blocks[size_class], &cache->blocks[size_class], PTHREADS_SLAB_BATCH);
+	pthreads_slab_depot.count[size_class] -= moved;
+	pthread_mutex_unlock(&pthreads_slab_depot.mutex);
+
+	cache->count[size_class] += moved;
+	return 1;
+} /* }}} */
+
+/* {{{ */
+static void pthreads_slab_spill(pthreads_slab_cache_t *cache, uint32_t size_class, uint32_t count) {
+	uint32_t moved;
+
+	pthread_mutex_lock(&pthreads_slab_depot.mutex);
+	pthreads_slab_collect_stats(cache);
+	moved = pthreads_slab_move(&cache->blocks[size_class], &pthreads_slab_depot.blocks[size_class], count);
+	pthreads_slab_depot.count[size_class] += moved;
+	pthread_mutex_unlock(&pthreads_slab_depot.mutex);
+
+	cache->count[size_class] -= moved;
+} /* }}} */
+
+/* {{{ */
+void* pthreads_slab_alloc(size_t size) {
+	pthreads_slab_cache_t *cache = &PTHREADS_ZG(slab_cache);
+	pthreads_slab_block_t *block;
+	uint32_t size_class;
+
+	cache->stats.allocations++;
+	if (size == 0 || size > PTHREADS_SLAB_MAX_SIZE) {
+		cache->stats.oversized++;
+		return malloc(size);
+	}
+
+	size_class = PTHREADS_SLAB_CLASS(size);
+	if (cache->blocks[size_class] != NULL) {
+		cache->stats.cache_hits++;
+	} else if (!pthreads_slab_refill(cache, size_class)) {
+		return NULL;
+	}
+
+	block = cache->blocks[size_class];
+	cache->blocks[size_class] = block->next;
+	cache->count[size_class]--;
+	return block;
+} /* }}} */
+
+/* {{{ */
+void pthreads_slab_free(void* ptr, size_t size) {
+	pthreads_slab_cache_t *cache;
+	pthreads_slab_block_t *block = ptr;
+	uint32_t size_class;
+
+	if (block == NULL) {
+		return;
+	}
+	if (size == 0 || size > PTHREADS_SLAB_MAX_SIZE) {
+		free(block);
+		return;
+	}
+
+	//the block may have come from another thread's cache, which doesn't matter, since all blocks belong to the depot
+	cache = &PTHREADS_ZG(slab_cache);
+	size_class = PTHREADS_SLAB_CLASS(size);
+	block->next = cache->blocks[size_class];
+	cache->blocks[size_class] = block;
+	if (++cache->count[size_class] > PTHREADS_SLAB_CACHE_MAX) {
+		pthreads_slab_spill(cache, size_class, PTHREADS_SLAB_BATCH);
+	}
+} /* }}} */
+
+/* {{{ */
+void pthreads_slab_flush(void) {
+	pthreads_slab_cache_t *cache = &PTHREADS_ZG(slab_cache);
+
+	for (uint32_t size_class = 0; size_class < PTHREADS_SLAB_CLASSES; size_class++) {
+		pthreads_slab_spill(cache, size_class, cache->count[size_class]);
+	}
+} /* }}} */
+
+/* {{{ */
+void pthreads_slab_get_stats(pthreads_slab_stats_t* stats) {
+	pthreads_slab_cache_t *cache = &PTHREADS_ZG(slab_cache);
+
+	pthread_mutex_lock(&pthreads_slab_depot.mutex);
+	pthreads_slab_collect_stats(cache);
+	memcpy(stats, &pthreads_slab_depot.stats, sizeof(pthreads_slab_stats_t));
+	pthread_mutex_unlock(&pthreads_slab_depot.mutex);
+} /* }}} */
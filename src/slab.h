@@ -0,0 +1,67 @@
+/*
+  +----------------------------------------------------------------------+
+  | pthreads                                                             |
+  +----------------------------------------------------------------------+
+  | Copyright (c) Joe Watkins 2012 - 2015                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Joe Watkins <krakjoe@php.net>                                |
+  +----------------------------------------------------------------------+
+ */
+#ifndef HAVE_PTHREADS_SLAB_H
+#define HAVE_PTHREADS_SLAB_H
+
+#include <zend.h>
+
+/* {{{ small fixed size blocks, like store nodes, are carved out of slabs by size class, and recycled through a cache
+	per thread, so that most allocations and frees don't touch the system allocator or any lock
+	blocks don't belong to the thread which allocated them, so they may be freed by any thread */
+#define PTHREADS_SLAB_ALIGNMENT 16
+#define PTHREADS_SLAB_CLASSES 4 //16, 32, 48 and 64 bytes; bigger blocks are malloc()'d directly
+#define PTHREADS_SLAB_MAX_SIZE (PTHREADS_SLAB_ALIGNMENT * PTHREADS_SLAB_CLASSES)
+#define PTHREADS_SLAB_BLOCKS 128 //blocks per slab
+#define PTHREADS_SLAB_BATCH 32 //blocks moved at once between a thread's cache and the shared depot
+#define PTHREADS_SLAB_CACHE_MAX (PTHREADS_SLAB_BATCH * 2) //blocks per size class a thread may keep
+/* }}} */
+
+typedef struct _pthreads_slab_block_t {
+	struct _pthreads_slab_block_t *next;
+} pthreads_slab_block_t;
+
+/* {{{ usage counters; allocations - slabs - oversized is the number of malloc() calls avoided */
+typedef struct _pthreads_slab_stats_t {
+	uint64_t allocations; //blocks handed out
+	uint64_t cache_hits; //allocations served from the calling thread's cache, without locking
+	uint64_t slabs; //slabs obtained from the system allocator
+	uint64_t oversized; //allocations too big for any size class, which were malloc()'d directly
+} pthreads_slab_stats_t; /* }}} */
+
+/* {{{ per thread cache, lives in module globals */
+typedef struct _pthreads_slab_cache_t {
+	pthreads_slab_block_t *blocks[PTHREADS_SLAB_CLASSES];
+	uint32_t count[PTHREADS_SLAB_CLASSES];
+	pthreads_slab_stats_t stats; //not yet added to the global counters
+} pthreads_slab_cache_t; /* }}} */
+
+/* {{{ */
+zend_result pthreads_slab_init(void);
+void pthreads_slab_shutdown(void); /* }}} */
+
+/* {{{ size must be the same for alloc and free */
+void* pthreads_slab_alloc(size_t size);
+void pthreads_slab_free(void* block, size_t size); /* }}} */
+
+/* {{{ returns all blocks cached by the calling thread to the depot */
+void pthreads_slab_flush(void); /* }}} */
+
+/* {{{ */
+void pthreads_slab_get_stats(pthreads_slab_stats_t* stats); /* }}} */
+
+#endif
@@ -25,6 +25,7 @@
 #include <src/prepare.h>
 #include <src/store_types.h>
 #include <src/thread.h>
+#include <src/atomic.h>
 #include <Zend/zend_ast.h>
 #if PHP_VERSION_ID >= 80100
 #include <Zend/zend_enum.h>
@@ -37,18 +38,246 @@ static zend_result pthreads_store_save_zval(pthreads_ident_t* source, zval* zsto
 static void pthreads_store_restore_zval_ex(zval* unstore, zval* zstorage, zend_bool* was_pthreads_storage);
 static void pthreads_store_restore_zval(zval* unstore, zval* zstorage); /* }}} */
 static void pthreads_store_storage_dtor(zval* element);
+static uint64_t pthreads_store_get_local_serial(pthreads_zend_object_t* threaded, zend_ulong idx, zend_string* name);
+
+static volatile uint64_t pthreads_store_serial = 0;
+
+/* {{{ */
+static zend_always_inline uint64_t pthreads_store_next_serial(void) {
+	return pthreads_atomic_fetch_add_u64(&pthreads_store_serial, 1) + 1;
+} /* }}} */
+
+/* {{{ */
+static void pthreads_store_scalar_cell_dtor(zval* element) {
+	free(Z_PTR_P(element));
+} /* }}} */
 
 /* {{{ */
 void pthreads_store_init(pthreads_store_t* store) {
 	store->modcount = 0;
+	store->count = 0;
+	//left uninitialized, so that Zend makes it packed if the first key is an integer, until a key is added out of order
 	zend_hash_init(
 		&store->hash, 8, NULL,
 		(dtor_func_t)pthreads_store_storage_dtor, 1);
+	zend_hash_init(
+		&store->scalar_cells, 8, NULL,
+		(dtor_func_t)pthreads_store_scalar_cell_dtor, 1);
+	store->slots = NULL;
+	store->slots_count = 0;
+	store->ring = NULL;
+	store->changes = NULL;
+	store->waiters = 0;
+} /* }}} */
+
+/* {{{ */
+void pthreads_store_init_slots(pthreads_store_t* store, uint32_t count) {
+	if (count == 0) {
+		return;
+	}
+	store->slots = malloc(sizeof(uint32_t) * count);
+	if (store->slots != NULL) {
+		//all bits set is never a valid bucket index
+		memset((void*) store->slots, 0xff, sizeof(uint32_t) * count);
+		store->slots_count = count;
+	}
+} /* }}} */
+
+/* {{{ */
+void pthreads_store_init_ring(pthreads_store_t* store) {
+	//items are allocated on first push, since connections to existing objects discard the store created for them
+	store->ring = calloc(1, sizeof(pthreads_store_ring_t));
+} /* }}} */
+
+/* {{{ */
+static void pthreads_store_destroy_ring(pthreads_store_ring_t* ring) {
+	uint32_t i;
+
+	for (i = 0; i < ring->count; i++) {
+		pthreads_store_storage_dtor(&ring->items[(ring->head + i) & (ring->size - 1)]);
+	}
+	if (ring->items != NULL) {
+		free(ring->items);
+	}
+	free(ring);
 } /* }}} */
 
 /* {{{ */
 void pthreads_store_destroy(pthreads_store_t* store) {
 	zend_hash_destroy(&store->hash);
+	zend_hash_destroy(&store->scalar_cells);
+	if (store->slots != NULL) {
+		free((void*) store->slots);
+		store->slots = NULL;
+		store->slots_count = 0;
+	}
+	if (store->ring != NULL) {
+		pthreads_store_destroy_ring(store->ring);
+		store->ring = NULL;
+	}
+	if (store->changes != NULL) {
+		for (uint32_t i = 0; i < PTHREADS_STORE_CHANGELOG_SIZE; i++) {
+			if (store->changes[i].name != NULL) {
+				zend_string_release_ex(store->changes[i].name, 1);
+			}
+		}
+		free(store->changes);
+		store->changes = NULL;
+	}
+} /* }}} */
+
+/* {{{ Finds a member in the store, using the property slot number to skip the hash lookup if possible
+	Must be called with the monitor held, at least shared */
+static zval* pthreads_store_find(pthreads_store_t* store, zval* member, uint32_t slot) {
+	HashTable* ht = &store->hash;
+	zval* zstorage;
+
+	if (Z_TYPE_P(member) == IS_LONG) {
+		return zend_hash_index_find(ht, Z_LVAL_P(member));
+	}
+
+	if (slot >= store->slots_count || (HT_FLAGS(ht) & HASH_FLAG_PACKED)) {
+		return zend_hash_find(ht, Z_STR_P(member));
+	}
+
+	uint32_t idx = pthreads_atomic_load_u32(&store->slots[slot]);
+	if (idx < ht->nNumUsed) {
+		Bucket* bucket = ht->arData + idx;
+
+		//the index is only a hint; the bucket may since have been deleted, or reused for something else by a rehash
+		if (
+			Z_TYPE(bucket->val) != IS_UNDEF &&
+			bucket->key != NULL &&
+			(bucket->key == Z_STR_P(member) || zend_string_equal_content(bucket->key, Z_STR_P(member)))
+		) {
+			return &bucket->val;
+		}
+	}
+
+	zstorage = zend_hash_find(ht, Z_STR_P(member));
+	if (zstorage != NULL) {
+		//this may race with other readers holding the lock shared, but they'd all be storing the same value
+		pthreads_atomic_store_u32(&store->slots[slot], (uint32_t) ((Bucket*) zstorage - ht->arData));
+	}
+	return zstorage;
+} /* }}} */
+
+/* {{{ Sizes an empty store for the contents of a packed table, before they are copied in order
+	The hash is created packed by Zend anyway when 0..n-1 are appended, but this avoids growing it repeatedly, and
+	keeps it packed when the first key is beyond the default size */
+static void pthreads_store_reserve_packed(pthreads_store_t* store, HashTable* source) {
+	HashTable* ht = &store->hash;
+
+	if (!(HT_FLAGS(ht) & HASH_FLAG_UNINITIALIZED) || !HT_IS_PACKED(source) || source->nNumUsed == 0) {
+		return;
+	}
+	zend_hash_extend(ht, source->nNumUsed, 1);
+} /* }}} */
+
+/* {{{ */
+static inline zend_bool pthreads_store_is_scalar(zval* zstorage) {
+	return zstorage != NULL && Z_TYPE_P(zstorage) >= IS_NULL && Z_TYPE_P(zstorage) <= IS_DOUBLE;
+} /* }}} */
+
+/* {{{ Optimistically reads a scalar cell without taking the monitor
+	Returns 0 if the member isn't scalar, or if writers kept racing us */
+static inline zend_bool pthreads_store_scalar_cell_read(pthreads_store_scalar_cell_t* cell, zval* read) {
+	uint32_t before, after;
+	zval copy;
+	int attempts = 0;
+
+	do {
+		before = pthreads_atomic_load_u32(&cell->seq);
+		if (before & 1) {
+			continue; //write in progress
+		}
+		ZVAL_COPY_VALUE(&copy, &cell->value);
+		pthreads_atomic_fence_acquire();
+		after = pthreads_atomic_load_u32(&cell->seq);
+
+		if (before == after) {
+			if (Z_ISUNDEF(copy)) {
+				return 0;
+			}
+			ZVAL_COPY_VALUE(read, &copy);
+			return 1;
+		}
+	} while (++attempts < 8);
+
+	return 0;
+} /* }}} */
+
+/* {{{ Must be called with the monitor held */
+static inline void pthreads_store_scalar_cell_write(pthreads_store_scalar_cell_t* cell, zval* zstorage) {
+	uint32_t seq = cell->seq;
+
+	pthreads_atomic_store_u32(&cell->seq, seq + 1);
+	pthreads_atomic_fence_release();
+	if (pthreads_store_is_scalar(zstorage)) {
+		ZVAL_COPY_VALUE(&cell->value, zstorage);
+	} else {
+		ZVAL_UNDEF(&cell->value);
+	}
+	pthreads_atomic_store_u32(&cell->seq, seq + 2);
+} /* }}} */
+
+/* {{{ Publishes a change of the given member to lock-free readers, if any thread has created a cell for it
+	zstorage may be NULL if the member was deleted */
+static inline void pthreads_store_publish_scalar(pthreads_store_t* store, zval* key, zval* zstorage) {
+	pthreads_store_scalar_cell_t* cell;
+
+	if (Z_TYPE_P(key) != IS_STRING || zend_hash_num_elements(&store->scalar_cells) == 0) {
+		return;
+	}
+
+	cell = zend_hash_find_ptr(&store->scalar_cells, Z_STR_P(key));
+	if (cell != NULL) {
+		pthreads_store_scalar_cell_write(cell, zstorage);
+	}
+} /* }}} */
+
+/* {{{ Publishes the number of members to lock-free readers, and wakes threads waiting for a condition on the members;
+	must be called with the monitor held after any change to the members */
+static zend_always_inline void pthreads_store_publish_changes(pthreads_object_t* ts_obj) {
+	pthreads_atomic_store_u32(&ts_obj->props.count, zend_hash_num_elements(&ts_obj->props.hash));
+
+	if (ts_obj->props.waiters > 0) {
+		//the conditions are cheap to evaluate, so it's simpler to wake everyone than to work out who's interested
+		pthreads_monitor_notify_ex(&ts_obj->monitor, PTHREADS_MONITOR_QUEUE_MEMBERS, NULL, 1);
+	}
+} /* }}} */
+
+/* {{{ Finds or creates the scalar cell for the given member and remembers it in the local object, so that
+	subsequent reads of it on this thread don't need to acquire the monitor. Must be called with the monitor held */
+static void pthreads_store_resolve_scalar_cell(pthreads_zend_object_t* threaded, zend_string* name, zval* zstorage) {
+	pthreads_store_t* store = &threaded->ts_obj->props;
+	pthreads_store_scalar_cell_t* cell = zend_hash_find_ptr(&store->scalar_cells, name);
+
+	if (cell == NULL) {
+		cell = malloc(sizeof(pthreads_store_scalar_cell_t));
+		if (cell == NULL) {
+			return;
+		}
+		cell->seq = 0;
+		ZVAL_COPY_VALUE(&cell->value, zstorage);
+
+		if (GC_FLAGS(name) & IS_STR_PERMANENT) {
+			zend_hash_add_new_ptr(&store->scalar_cells, name, cell);
+		} else {
+			zend_hash_str_add_new_ptr(&store->scalar_cells, ZSTR_VAL(name), ZSTR_LEN(name), cell);
+		}
+	}
+
+	if (threaded->local_scalar_cells == NULL) {
+		ALLOC_HASHTABLE(threaded->local_scalar_cells);
+		zend_hash_init(threaded->local_scalar_cells, 8, NULL, NULL, 0);
+	}
+	if ((GC_FLAGS(name) & (IS_STR_PERSISTENT|IS_STR_INTERNED)) == IS_STR_PERSISTENT) {
+		//refcounted persistent string from pthreads_store - we can't use it directly
+		zend_hash_str_update_ptr(threaded->local_scalar_cells, ZSTR_VAL(name), ZSTR_LEN(name), cell);
+	} else {
+		zend_hash_update_ptr(threaded->local_scalar_cells, name, cell);
+	}
 } /* }}} */
 
 /* {{{ Prepares local property table to cache items.
@@ -60,67 +289,110 @@ static void pthreads_store_init_local_properties(zend_object* object) {
 	}
 } /* }}} */
 
+/* {{{ Checks whether a value in the local property cache still matches the member in the store
+	Must be called with the monitor held, at least shared */
+static zend_bool pthreads_store_local_property_is_valid(pthreads_zend_object_t *threaded, zend_ulong idx, zend_string *name, zval *val) {
+	pthreads_object_t *ts_obj = threaded->ts_obj;
+	zval *zstorage;
+	pthreads_storage *ts_val;
+
+	if (!name) {
+		zstorage = zend_hash_index_find(&ts_obj->props.hash, idx);
+	} else {
+		zstorage = zend_hash_find(&ts_obj->props.hash, name);
+	}
+	ts_val = TRY_PTHREADS_STORAGE_PTR_P(zstorage);
+
+	ZVAL_DEINDIRECT(val);
+	if (ts_val) {
+		if (ts_val->type == STORE_TYPE_PTHREADS && IS_PTHREADS_OBJECT(val)) {
+			pthreads_zend_object_t* shared = ((pthreads_zend_object_storage_t*)ts_val)->object;
+			pthreads_zend_object_t* local = PTHREADS_FETCH_FROM(Z_OBJ_P(val));
+
+			return
+				shared == local || //same object
+				(pthreads_globals_object_valid(shared) && shared->ts_obj == local->ts_obj); //connection to a valid foreign object
+		} else if (ts_val->type == STORE_TYPE_CLOSURE && IS_PTHREADS_CLOSURE_OBJECT(val)) {
+			zend_closure* shared = ((pthreads_closure_storage_t*)ts_val)->closure;
+			zend_closure* local = (zend_closure*)Z_OBJ_P(val);
+			return shared == local;
+#if HAVE_PTHREADS_EXT_SOCKETS_SUPPORT
+		} else if (ts_val->type == STORE_TYPE_SOCKET && IS_EXT_SOCKETS_OBJECT(val)) {
+			pthreads_socket_storage_t* shared = (pthreads_socket_storage_t*)ts_val;
+			php_socket* local = Z_SOCKET_P(val);
+			return shared->bsd_socket == local->bsd_socket;
+#endif
+		} else if (ts_val->type == STORE_TYPE_ARRAY && Z_TYPE_P(val) == IS_ARRAY) {
+			//arrays are copied on restore, so the only way to tell is to check where this one came from
+			return pthreads_store_get_local_serial(threaded, idx, name) == ts_val->serial;
+		} else if (ts_val->type == STORE_TYPE_STRING_PTR && Z_TYPE_P(val) == IS_STRING) {
+			pthreads_string_storage_t* string = (pthreads_string_storage_t*)ts_val;
+			if (string->owner.ls == TSRMLS_CACHE && string->string == Z_STR_P(val)) {
+				//the owner thread's ref is the string in the store itself
+				return 1;
+			}
+			//other threads hold a copy of it, which is still good as long as the storage wasn't replaced
+			return pthreads_store_get_local_serial(threaded, idx, name) == ts_val->serial;
+		} else if ((ts_val->type == STORE_TYPE_SHARED_STRING || ts_val->type == STORE_TYPE_INLINE_STRING) && Z_TYPE_P(val) == IS_STRING) {
+			return pthreads_store_get_local_serial(threaded, idx, name) == ts_val->serial;
+		}
+	} else if (zstorage && Z_TYPE_P(zstorage) == IS_STRING && Z_TYPE_P(val) == IS_STRING) {
+		//interned and permanent strings are restored without copying
+		return Z_STR_P(zstorage) == Z_STR_P(val);
+	}
+
+	return 0;
+} /* }}} */
+
+/* {{{ Revalidates only the members changed since the last sync, if the change log still covers all of them */
+static zend_bool pthreads_store_sync_local_properties_from_log(pthreads_zend_object_t *threaded) {
+	pthreads_store_t *store = &threaded->ts_obj->props;
+	HashTable *properties = threaded->std.properties;
+	zend_long modcount;
+
+	if (store->changes == NULL || store->modcount - threaded->local_props_modcount > PTHREADS_STORE_CHANGELOG_SIZE) {
+		return 0;
+	}
+
+	for (modcount = threaded->local_props_modcount + 1; modcount <= store->modcount; modcount++) {
+		if (store->changes[modcount & (PTHREADS_STORE_CHANGELOG_SIZE - 1)].modcount != modcount) {
+			//overwritten by a later change, or the member wasn't recorded
+			return 0;
+		}
+	}
+
+	for (modcount = threaded->local_props_modcount + 1; modcount <= store->modcount; modcount++) {
+		pthreads_store_change_t *change = &store->changes[modcount & (PTHREADS_STORE_CHANGELOG_SIZE - 1)];
+		zval *val = change->name ?
+			zend_hash_find(properties, change->name) :
+			zend_hash_index_find(properties, change->idx);
+
+		if (val && !pthreads_store_local_property_is_valid(threaded, change->idx, change->name, val)) {
+			if (!change->name) {
+				zend_hash_index_del(properties, change->idx);
+			} else {
+				zend_hash_del(properties, change->name);
+			}
+		}
+	}
+
+	return 1;
+} /* }}} */
+
 void pthreads_store_sync_local_properties(zend_object* object) { /* {{{ */
 	pthreads_zend_object_t *threaded = PTHREADS_FETCH_FROM(object);
 	pthreads_object_t *ts_obj = threaded->ts_obj;
 	zend_ulong idx;
 	zend_string *name;
 	zval *val;
-	pthreads_storage *ts_val;
-	zend_bool remove;
 
 	if (threaded->local_props_modcount == ts_obj->props.modcount) {
 		return;
 	}
 
-	if (threaded->std.properties) {
+	if (threaded->std.properties && !pthreads_store_sync_local_properties_from_log(threaded)) {
 		ZEND_HASH_FOREACH_KEY_VAL(threaded->std.properties, idx, name, val) {
-			if (!name) {
-				ts_val = TRY_PTHREADS_STORAGE_PTR_P(zend_hash_index_find(&ts_obj->props.hash, idx));
-			} else {
-				ts_val = TRY_PTHREADS_STORAGE_PTR_P(zend_hash_find(&ts_obj->props.hash, name));
-			}
-
-			remove = 1;
-			if (ts_val) {
-				ZVAL_DEINDIRECT(val);
-				if (ts_val->type == STORE_TYPE_PTHREADS && IS_PTHREADS_OBJECT(val)) {
-					pthreads_zend_object_t* shared = ((pthreads_zend_object_storage_t*)ts_val)->object;
-					pthreads_zend_object_t* local = PTHREADS_FETCH_FROM(Z_OBJ_P(val));
-
-					if (
-						shared == local || //same object
-						(pthreads_globals_object_valid(shared) && shared->ts_obj == local->ts_obj) //connection to a valid foreign object
-					) {
-						remove = 0;
-					}
-				} else if (ts_val->type == STORE_TYPE_CLOSURE && IS_PTHREADS_CLOSURE_OBJECT(val)) {
-					zend_closure* shared = ((pthreads_closure_storage_t*)ts_val)->closure;
-					zend_closure* local = (zend_closure*)Z_OBJ_P(val);
-					if (shared == local) {
-						remove = 0;
-					}
-#if HAVE_PTHREADS_EXT_SOCKETS_SUPPORT
-				} else if (ts_val->type == STORE_TYPE_SOCKET && IS_EXT_SOCKETS_OBJECT(val)) {
-					pthreads_socket_storage_t* shared = (pthreads_socket_storage_t*)ts_val;
-					php_socket* local = Z_SOCKET_P(val);
-					if (shared->bsd_socket == local->bsd_socket) {
-						remove = 0;
-					}
-#endif
-				} else if (ts_val->type == STORE_TYPE_STRING_PTR && Z_TYPE_P(val) == IS_STRING) {
-					pthreads_string_storage_t* string = (pthreads_string_storage_t*)ts_val;
-					if (string->owner.ls == TSRMLS_CACHE && string->string == Z_STR_P(val)) {
-						//local caching of this by other threads is probably fine too, but fully caching it would probably
-						//require bytewise comparison, which isn't gonna be very performant
-						//it should be sufficient to only persist the owner thread's ref, since that's where copies will be
-						//made from anyway.
-						remove = 0;
-					}
-				}
-			}
-
-			if (remove) {
+			if (!pthreads_store_local_property_is_valid(threaded, idx, name, val)) {
 				if (!name) {
 					zend_hash_index_del(threaded->std.properties, idx);
 				}
@@ -134,8 +406,16 @@ void pthreads_store_sync_local_properties(zend_object* object) { /* {{{ */
 	threaded->local_props_modcount = ts_obj->props.modcount;
 } /* }}} */
 
+/* {{{ */
+void pthreads_store_invalidate_local_properties(zend_object* object) {
+	pthreads_zend_object_t *threaded = PTHREADS_FETCH_FROM(object);
+
+	//far enough behind that the change log can't cover it
+	threaded->local_props_modcount = threaded->ts_obj->props.modcount - PTHREADS_STORE_CHANGELOG_SIZE - 1;
+} /* }}} */
+
 static inline zend_bool pthreads_store_retain_in_local_cache(zval* val) {
-	return IS_PTHREADS_OBJECT(val) || IS_PTHREADS_CLOSURE_OBJECT(val) || IS_EXT_SOCKETS_OBJECT(val) || Z_TYPE_P(val) == IS_STRING;
+	return IS_PTHREADS_OBJECT(val) || IS_PTHREADS_CLOSURE_OBJECT(val) || IS_EXT_SOCKETS_OBJECT(val) || Z_TYPE_P(val) == IS_STRING || Z_TYPE_P(val) == IS_ARRAY;
 }
 
 static inline zend_bool pthreads_store_valid_local_cache_item(zval* val) {
@@ -147,7 +427,50 @@ static inline zend_bool pthreads_store_valid_local_cache_item(zval* val) {
 /* {{{ */
 static inline zend_bool pthreads_store_storage_is_cacheable(zval* zstorage) {
 	pthreads_storage* storage = TRY_PTHREADS_STORAGE_PTR_P(zstorage);
-	return storage && (storage->type == STORE_TYPE_PTHREADS || storage->type == STORE_TYPE_CLOSURE || storage->type == STORE_TYPE_SOCKET || storage->type == STORE_TYPE_STRING_PTR);
+	if (storage == NULL) {
+		//permanent strings are cached too, so replacing them must invalidate local caches
+		return zstorage != NULL && Z_TYPE_P(zstorage) == IS_STRING;
+	}
+	return (storage->type == STORE_TYPE_PTHREADS || storage->type == STORE_TYPE_CLOSURE || storage->type == STORE_TYPE_SOCKET || storage->type == STORE_TYPE_STRING_PTR || storage->type == STORE_TYPE_SHARED_STRING || storage->type == STORE_TYPE_INLINE_STRING || storage->type == STORE_TYPE_ARRAY);
+} /* }}} */
+
+/* {{{ Remembers which storage a value in the local property cache was restored from, for values which can't be
+	validated by identity (e.g. arrays and foreign strings, which are copied) */
+static void pthreads_store_set_local_serial(pthreads_zend_object_t* threaded, zval* key, uint64_t serial) {
+	zval zserial;
+
+	if (threaded->local_props_serials == NULL) {
+		ALLOC_HASHTABLE(threaded->local_props_serials);
+		zend_hash_init(threaded->local_props_serials, 8, NULL, NULL, 0);
+	}
+
+	ZVAL_LONG(&zserial, (zend_long) serial);
+	if (Z_TYPE_P(key) == IS_LONG) {
+		zend_hash_index_update(threaded->local_props_serials, Z_LVAL_P(key), &zserial);
+	} else {
+		zend_string* str_key = Z_STR_P(key);
+		if ((GC_FLAGS(str_key) & (IS_STR_PERSISTENT|IS_STR_INTERNED)) == IS_STR_PERSISTENT) {
+			//refcounted persistent string from pthreads_store - we can't use it directly
+			zend_hash_str_update(threaded->local_props_serials, ZSTR_VAL(str_key), ZSTR_LEN(str_key), &zserial);
+		} else {
+			zend_hash_update(threaded->local_props_serials, str_key, &zserial);
+		}
+	}
+} /* }}} */
+
+/* {{{ */
+static uint64_t pthreads_store_get_local_serial(pthreads_zend_object_t* threaded, zend_ulong idx, zend_string* name) {
+	zval* zserial;
+
+	if (threaded->local_props_serials == NULL) {
+		return 0;
+	}
+
+	if (!name) {
+		zserial = zend_hash_index_find(threaded->local_props_serials, idx);
+	} else zserial = zend_hash_find(threaded->local_props_serials, name);
+
+	return zserial ? (uint64_t) Z_LVAL_P(zserial) : 0;
 } /* }}} */
 
 /* {{{ Syncs all the cacheable properties from TS storage into local cache */
@@ -187,8 +510,17 @@ void pthreads_store_full_sync_local_properties(zend_object *object) {
 			continue;
 		}
 		if (pthreads_store_storage_is_cacheable(zstorage)) {
+			pthreads_storage* storage = TRY_PTHREADS_STORAGE_PTR_P(zstorage);
 			pthreads_store_restore_zval(&pzval, zstorage);
 
+			if (storage != NULL && storage->serial != 0 && (Z_TYPE(pzval) == IS_ARRAY || Z_TYPE(pzval) == IS_STRING)) {
+				zval key;
+				if (!name) {
+					ZVAL_LONG(&key, idx);
+				} else ZVAL_STR(&key, name);
+				pthreads_store_set_local_serial(threaded, &key, storage->serial);
+			}
+
 			if (IS_PTHREADS_OBJECT(&pzval)) {
 				pthreads_store_full_sync_local_properties(Z_OBJ(pzval));
 			}
@@ -214,8 +546,50 @@ void pthreads_store_full_sync_local_properties(zend_object *object) {
 	pthreads_monitor_unlock(&threaded->ts_obj->monitor);
 } /* }}} */
 
+/* {{{ Records the member changed by a modcount bump, so that other threads can sync only that member
+	key may be NULL if the change can't be attributed to a single member */
+static void pthreads_store_log_change(pthreads_store_t *store, zval *key) {
+	pthreads_store_change_t *change;
+
+	if (store->changes == NULL) {
+		store->changes = malloc(sizeof(pthreads_store_change_t) * PTHREADS_STORE_CHANGELOG_SIZE);
+		if (store->changes == NULL) {
+			return;
+		}
+		memset(store->changes, 0, sizeof(pthreads_store_change_t) * PTHREADS_STORE_CHANGELOG_SIZE);
+		for (uint32_t i = 0; i < PTHREADS_STORE_CHANGELOG_SIZE; i++) {
+			store->changes[i].modcount = -1;
+		}
+	}
+
+	change = &store->changes[store->modcount & (PTHREADS_STORE_CHANGELOG_SIZE - 1)];
+	if (change->name != NULL) {
+		zend_string_release_ex(change->name, 1);
+		change->name = NULL;
+	}
+
+	if (key == NULL) {
+		change->modcount = -1;
+		return;
+	}
+
+	change->modcount = store->modcount;
+	if (Z_TYPE_P(key) == IS_LONG) {
+		change->idx = Z_LVAL_P(key);
+	} else {
+		change->idx = 0;
+		if (GC_FLAGS(Z_STR_P(key)) & IS_STR_PERMANENT) {
+			change->name = Z_STR_P(key);
+		} else {
+			change->name = zend_string_init(Z_STRVAL_P(key), Z_STRLEN_P(key), 1);
+			//other threads will look this up while holding the lock shared, so it mustn't be written to later
+			zend_string_hash_val(change->name);
+		}
+	}
+} /* }}} */
+
 /* {{{ */
-static inline void _pthreads_store_bump_modcount_nolock(pthreads_zend_object_t *threaded) {
+static inline void _pthreads_store_bump_modcount_nolock(pthreads_zend_object_t *threaded, zval *key) {
 	if (threaded->local_props_modcount == threaded->ts_obj->props.modcount) {
 		/* It's possible we may have caused a modification via a connection whose property table was not in sync. This is OK
 		 * for writes, because these cases usually cause destruction of outdated caches anyway, but we have to avoid
@@ -224,6 +598,7 @@ static inline void _pthreads_store_bump_modcount_nolock(pthreads_zend_object_t *
 		threaded->local_props_modcount++;
 	}
 	threaded->ts_obj->props.modcount++;
+	pthreads_store_log_change(&threaded->ts_obj->props, key);
 } /* }}} */
 
 static inline zend_bool pthreads_store_coerce(zval *key, zval *member) {
@@ -259,6 +634,11 @@ static inline zend_bool pthreads_store_member_is_cacheable(zend_object *object,
 
 /* {{{ */
 int pthreads_store_delete(zend_object *object, zval *key) {
+	return pthreads_store_delete_ex(object, key, PTHREADS_STORE_NO_SLOT);
+} /* }}} */
+
+/* {{{ */
+int pthreads_store_delete_ex(zend_object *object, zval *key, uint32_t slot) {
 	int result = FAILURE;
 	zval member;
 	pthreads_zend_object_t *threaded = PTHREADS_FETCH_FROM(object);
@@ -266,13 +646,26 @@ int pthreads_store_delete(zend_object *object, zval *key) {
 	zend_bool coerced = pthreads_store_coerce(key, &member);
 
 	if (pthreads_monitor_lock(&ts_obj->monitor)) {
-		zend_bool was_pthreads_object = pthreads_store_member_is_cacheable(object, &member);
-		if (Z_TYPE(member) == IS_LONG) {
-			result = zend_hash_index_del(&ts_obj->props.hash, Z_LVAL(member));
-		} else result = zend_hash_del(&ts_obj->props.hash, Z_STR(member));
+		zval *zstorage = pthreads_store_find(&ts_obj->props, &member, slot);
+		zend_bool was_pthreads_object = pthreads_store_storage_is_cacheable(zstorage);
+
+		if (zstorage != NULL) {
+			if (Z_TYPE(member) == IS_LONG) {
+				//the table might be packed, in which case there's no Bucket to delete
+				result = zend_hash_index_del(&ts_obj->props.hash, Z_LVAL(member));
+			} else {
+				//val is the first member of Bucket
+				zend_hash_del_bucket(&ts_obj->props.hash, (Bucket*) zstorage);
+				result = SUCCESS;
+			}
+		}
 
+		if (result == SUCCESS) {
+			pthreads_store_publish_scalar(&ts_obj->props, &member, NULL);
+			pthreads_store_publish_changes(ts_obj);
+		}
 		if (result == SUCCESS && was_pthreads_object) {
-			_pthreads_store_bump_modcount_nolock(threaded);
+			_pthreads_store_bump_modcount_nolock(threaded, &member);
 		}
 		//TODO: sync local properties?
 		pthreads_monitor_unlock(&ts_obj->monitor);
@@ -291,20 +684,72 @@ int pthreads_store_delete(zend_object *object, zval *key) {
 }
 /* }}} */
 
+/* {{{ Answers isset() without the monitor if the member is a scalar with a cell on this thread, or a value in this
+	thread's local cache while it's in sync; returns 0 if the monitor is needed to tell */
+static zend_bool pthreads_store_isset_optimistic(pthreads_zend_object_t *threaded, zval *member, int has_set_exists, zend_bool *isset) {
+	pthreads_object_t *ts_obj = threaded->ts_obj;
+	zval *cached;
+
+	if (threaded->local_scalar_cells != NULL && Z_TYPE_P(member) == IS_STRING) {
+		pthreads_store_scalar_cell_t* cell = zend_hash_find_ptr(threaded->local_scalar_cells, Z_STR_P(member));
+		zval value;
+
+		if (cell != NULL && pthreads_store_scalar_cell_read(cell, &value)) {
+			switch (has_set_exists) {
+				case ZEND_PROPERTY_NOT_EMPTY: *isset = zend_is_true(&value); break;
+				case ZEND_PROPERTY_ISSET: *isset = Z_TYPE(value) != IS_NULL; break;
+				default: *isset = 1; break;
+			}
+			return 1;
+		}
+	}
+
+	if (
+		has_set_exists != ZEND_PROPERTY_NOT_EMPTY && //cached values are never null, but may be empty
+		threaded->std.properties != NULL &&
+		//any change to a cached member bumps the modcount, so if we're in sync, the cached member still exists
+		threaded->local_props_modcount == *(volatile zend_long*) &ts_obj->props.modcount
+	) {
+		cached = Z_TYPE_P(member) == IS_LONG ?
+			zend_hash_index_find(threaded->std.properties, Z_LVAL_P(member)) :
+			zend_hash_find(threaded->std.properties, Z_STR_P(member));
+		if (cached != NULL && pthreads_store_valid_local_cache_item(cached)) {
+			*isset = 1;
+			return 1;
+		}
+	}
+
+	return 0;
+} /* }}} */
+
 /* {{{ */
 zend_bool pthreads_store_isset(zend_object *object, zval *key, int has_set_exists) {
+	return pthreads_store_isset_ex(object, key, PTHREADS_STORE_NO_SLOT, has_set_exists);
+} /* }}} */
+
+/* {{{ */
+zend_bool pthreads_store_isset_ex(zend_object *object, zval *key, uint32_t slot, int has_set_exists) {
 	zend_bool isset = 0;
 	zval member;
 	pthreads_zend_object_t *threaded = PTHREADS_FETCH_FROM(object);
 	pthreads_object_t *ts_obj = threaded->ts_obj;
-	zend_bool coerced = pthreads_store_coerce(key, &member);
+	zend_bool coerced;
 
-	if (pthreads_monitor_lock(&ts_obj->monitor)) {
-		zval *zstorage;
+	if (pthreads_atomic_load_u32(&ts_obj->props.count) == 0) {
+		//nothing to find, which is the usual answer when polling, so don't contend with writers for it
+		return 0;
+	}
 
-		if (Z_TYPE(member) == IS_LONG) {
-			zstorage = zend_hash_index_find(&ts_obj->props.hash, Z_LVAL(member));
-		} else zstorage = zend_hash_find(&ts_obj->props.hash, Z_STR(member));
+	coerced = pthreads_store_coerce(key, &member);
+	if (pthreads_store_isset_optimistic(threaded, &member, has_set_exists, &isset)) {
+		if (coerced) {
+			zval_ptr_dtor(&member);
+		}
+		return isset;
+	}
+
+	if (pthreads_monitor_lock_shared(&ts_obj->monitor)) {
+		zval *zstorage = pthreads_store_find(&ts_obj->props, &member, slot);
 
 		if (zstorage) {
 			isset = 1;
@@ -341,6 +786,20 @@ zend_bool pthreads_store_isset(zend_object *object, zval *key, int has_set_exist
 							if (ZSTR_LEN(string->string) == 0 || ZSTR_VAL(string->string)[0] == '0') {
 								isset = 0;
 							}
+						} else if (storage->type == STORE_TYPE_SHARED_STRING) {
+							zend_string* string = ((pthreads_shared_string_storage_t*)storage)->string;
+							if (ZSTR_LEN(string) == 0 || ZSTR_VAL(string)[0] == '0') {
+								isset = 0;
+							}
+						} else if (storage->type == STORE_TYPE_INLINE_STRING) {
+							pthreads_inline_string_storage_t* string = (pthreads_inline_string_storage_t*)storage;
+							if (string->length == 0 || string->value[0] == '0') {
+								isset = 0;
+							}
+						} else if (storage->type == STORE_TYPE_ARRAY) {
+							if (zend_hash_num_elements(((pthreads_array_storage_t*)storage)->array) == 0) {
+								isset = 0;
+							}
 						}
 					} break;
 					default:
@@ -354,7 +813,7 @@ zend_bool pthreads_store_isset(zend_object *object, zval *key, int has_set_exist
 				ZEND_ASSERT(0);
 			}
 		}
-		pthreads_monitor_unlock(&ts_obj->monitor);
+		pthreads_monitor_unlock_shared(&ts_obj->monitor);
 	}
 
 	if (coerced)
@@ -363,58 +822,127 @@ zend_bool pthreads_store_isset(zend_object *object, zval *key, int has_set_exist
 	return isset;
 } /* }}} */
 
-static inline void pthreads_store_update_local_property(zend_object* object, zval* key, zval* value) {
-	if (pthreads_store_retain_in_local_cache(value)) {
-		pthreads_store_init_local_properties(object);
-		if (Z_TYPE_P(key) == IS_LONG) {
-			zend_hash_index_update(object->properties, Z_LVAL_P(key), value);
-		} else {
-			zend_string* str_key = Z_STR_P(key);
-			if ((GC_FLAGS(str_key) & (IS_STR_PERSISTENT|IS_STR_INTERNED)) == IS_STR_PERSISTENT) {
-				//refcounted persistent string from pthreads_store - we can't use it directly
-				//if a bucket with this key already exists, it'll be reused
-				zend_hash_str_update(object->properties, Z_STRVAL_P(key), Z_STRLEN_P(key), value);
-			} else {
-				//any other interned or emalloc'd strings should be safe to use directly here
-				zend_hash_update(object->properties, str_key, value);
+static inline void pthreads_store_update_local_property(zend_object* object, zval* key, zval* value, uint64_t serial) {
+	if (!pthreads_store_retain_in_local_cache(value) || (Z_TYPE_P(value) == IS_ARRAY && serial == 0)) {
+		//don't leave an outdated value behind, since the modcount may not have changed when this was written
+		//for arrays without a serial, we don't know which storage they came from, so we'd have no way to tell if
+		//they're outdated later
+		if (object->properties) {
+			zval* cached = Z_TYPE_P(key) == IS_LONG ?
+				zend_hash_index_find(object->properties, Z_LVAL_P(key)) :
+				zend_hash_find(object->properties, Z_STR_P(key));
+			if (cached && pthreads_store_valid_local_cache_item(cached)) {
+				if (Z_TYPE_P(key) == IS_LONG) {
+					zend_hash_index_del(object->properties, Z_LVAL_P(key));
+				} else zend_hash_del(object->properties, Z_STR_P(key));
 			}
 		}
-		Z_TRY_ADDREF_P(value);
+		return;
+	}
+
+	if ((Z_TYPE_P(value) == IS_ARRAY || Z_TYPE_P(value) == IS_STRING) && serial != 0) {
+		pthreads_store_set_local_serial(PTHREADS_FETCH_FROM(object), key, serial);
+	}
+	pthreads_store_init_local_properties(object);
+	if (Z_TYPE_P(key) == IS_LONG) {
+		zend_hash_index_update(object->properties, Z_LVAL_P(key), value);
+	} else {
+		zend_string* str_key = Z_STR_P(key);
+		if ((GC_FLAGS(str_key) & (IS_STR_PERSISTENT|IS_STR_INTERNED)) == IS_STR_PERSISTENT) {
+			//refcounted persistent string from pthreads_store - we can't use it directly
+			//if a bucket with this key already exists, it'll be reused
+			zend_hash_str_update(object->properties, Z_STRVAL_P(key), Z_STRLEN_P(key), value);
+		} else {
+			//any other interned or emalloc'd strings should be safe to use directly here
+			zend_hash_update(object->properties, str_key, value);
+		}
 	}
+	Z_TRY_ADDREF_P(value);
 }
 
-static inline zend_bool pthreads_store_update_shared_property(pthreads_object_t* ts_obj, zval* key, zval* zstorage) {
+static inline zend_bool pthreads_store_update_shared_property_ex(pthreads_object_t* ts_obj, zval* key, uint32_t slot, zval* zstorage) {
 	zend_bool result = FAILURE;
 	if (Z_TYPE_P(key) == IS_LONG) {
 		if (zend_hash_index_update(&ts_obj->props.hash, Z_LVAL_P(key), zstorage))
 			result = SUCCESS;
 	} else {
 		zend_string* str_key = Z_STR_P(key);
-		if (GC_FLAGS(str_key) & IS_STR_PERMANENT) {
+		zval* updated;
+		zval* existing = slot != PTHREADS_STORE_NO_SLOT ? pthreads_store_find(&ts_obj->props, key, slot) : NULL;
+
+		if (existing != NULL) {
+			//same as zend_hash_update() would do, minus the lookup
+			pthreads_store_storage_dtor(existing);
+			ZVAL_COPY_VALUE(existing, zstorage);
+			updated = existing;
+		} else if (GC_FLAGS(str_key) & IS_STR_PERMANENT) {
 			//only permanent strings can be used directly
-			if (zend_hash_update(&ts_obj->props.hash, str_key, zstorage)) {
-				result = SUCCESS;
-			}
+			updated = zend_hash_update(&ts_obj->props.hash, str_key, zstorage);
 		} else {
 			//refcounted or request-local interned string - this must be hard-copied, regardless of where it came from
-			if (zend_hash_str_update(&ts_obj->props.hash, ZSTR_VAL(str_key), ZSTR_LEN(str_key), zstorage)) {
-				result = SUCCESS;
+			updated = zend_hash_str_update(&ts_obj->props.hash, ZSTR_VAL(str_key), ZSTR_LEN(str_key), zstorage);
+		}
+
+		if (updated) {
+			if (slot < ts_obj->props.slots_count && existing == NULL) {
+				pthreads_atomic_store_u32(&ts_obj->props.slots[slot], (uint32_t) ((Bucket*) updated - ts_obj->props.hash.arData));
 			}
+			result = SUCCESS;
 		}
 	}
 
+	if (result == SUCCESS) {
+		pthreads_store_publish_scalar(&ts_obj->props, key, zstorage);
+		pthreads_store_publish_changes(ts_obj);
+	}
+
 	return result;
 }
 
+static inline zend_bool pthreads_store_update_shared_property(pthreads_object_t* ts_obj, zval* key, zval* zstorage) {
+	return pthreads_store_update_shared_property_ex(ts_obj, key, PTHREADS_STORE_NO_SLOT, zstorage);
+}
+
+/* {{{ Replaces the storage of a member, invalidating local caches if needed
+	Must be called with the monitor held exclusively */
+static int pthreads_store_replace_nolock(pthreads_zend_object_t* threaded, zval* member, uint32_t slot, zval* zstorage) {
+	pthreads_object_t* ts_obj = threaded->ts_obj;
+	zend_bool was_pthreads_object = pthreads_store_storage_is_cacheable(pthreads_store_find(&ts_obj->props, member, slot));
+	int result = pthreads_store_update_shared_property_ex(ts_obj, member, slot, zstorage);
+
+	if (result == SUCCESS && was_pthreads_object) {
+		_pthreads_store_bump_modcount_nolock(threaded, member);
+	}
+
+	return result;
+} /* }}} */
+
 /* {{{ */
 int pthreads_store_read(zend_object *object, zval *key, int type, zval *read) {
+	return pthreads_store_read_ex(object, key, PTHREADS_STORE_NO_SLOT, type, read);
+} /* }}} */
+
+/* {{{ */
+int pthreads_store_read_ex(zend_object *object, zval *key, uint32_t slot, int type, zval *read) {
 	int result = FAILURE;
+	uint64_t serial = 0;
 	zval member, *property = NULL;
 	pthreads_zend_object_t *threaded = PTHREADS_FETCH_FROM(object);
 	pthreads_object_t *ts_obj = threaded->ts_obj;
 	zend_bool coerced = pthreads_store_coerce(key, &member);
 
-	if (pthreads_monitor_lock(&ts_obj->monitor)) {
+	if (threaded->local_scalar_cells != NULL && Z_TYPE(member) == IS_STRING && (type == BP_VAR_R || type == BP_VAR_IS)) {
+		pthreads_store_scalar_cell_t* cell = zend_hash_find_ptr(threaded->local_scalar_cells, Z_STR(member));
+
+		if (cell != NULL && pthreads_store_scalar_cell_read(cell, read)) {
+			if (coerced) {
+				zval_ptr_dtor(&member);
+			}
+			return SUCCESS;
+		}
+	}
+
+	if (pthreads_monitor_lock_shared(&ts_obj->monitor)) {
 		if (threaded->std.properties) {
 			pthreads_store_sync_local_properties(object);
 
@@ -424,8 +952,11 @@ int pthreads_store_read(zend_object *object, zval *key, int type, zval *read) {
 				property = zend_hash_index_find(threaded->std.properties, Z_LVAL(member));
 			} else property = zend_hash_find(threaded->std.properties, Z_STR(member));
 
-			if (property && pthreads_store_valid_local_cache_item(property)) {
-				pthreads_monitor_unlock(&ts_obj->monitor);
+			if (
+				property && pthreads_store_valid_local_cache_item(property) &&
+				(type == BP_VAR_R || type == BP_VAR_IS || IS_PTHREADS_OBJECT(property)) //strictly only reads are supported for anything else
+			) {
+				pthreads_monitor_unlock_shared(&ts_obj->monitor);
 				ZVAL_DEINDIRECT(property);
 				ZVAL_COPY(read, property);
 				if (coerced) {
@@ -435,11 +966,7 @@ int pthreads_store_read(zend_object *object, zval *key, int type, zval *read) {
 			}
 		}
 
-		zval *zstorage;
-
-		if (Z_TYPE(member) == IS_LONG) {
-			zstorage = zend_hash_index_find(&ts_obj->props.hash, Z_LVAL(member));
-		} else zstorage = zend_hash_find(&ts_obj->props.hash, Z_STR(member));
+		zval *zstorage = pthreads_store_find(&ts_obj->props, &member, slot);
 
 		if (zstorage) {
 			pthreads_storage *serialized = TRY_PTHREADS_STORAGE_PTR_P(zstorage);
@@ -450,15 +977,28 @@ int pthreads_store_read(zend_object *object, zval *key, int type, zval *read) {
 			} else {
 				pthreads_store_restore_zval(read, zstorage);
 				result = SUCCESS;
+				if (serialized != NULL) {
+					serial = serialized->serial;
+				}
+
+				if (
+					Z_TYPE(member) == IS_STRING &&
+					ts_obj->monitor.rwlock == NULL && //the cells table may only be modified under an exclusive lock
+					pthreads_store_is_scalar(zstorage) &&
+					!IS_PTHREADS_THREADED_ARRAY(object->ce)
+				) {
+					/* hot scalar properties (counters, flags) can be read lock-free from now on */
+					pthreads_store_resolve_scalar_cell(threaded, Z_STR(member), zstorage);
+				}
 			}
 		}
-		pthreads_monitor_unlock(&ts_obj->monitor);
+		pthreads_monitor_unlock_shared(&ts_obj->monitor);
 	}
 
 	if (result != SUCCESS) {
 		ZVAL_UNDEF(read);
 	} else {
-		pthreads_store_update_local_property(&threaded->std, &member, read);
+		pthreads_store_update_local_property(&threaded->std, &member, read, serial);
 	}
 
 	if (coerced)
@@ -491,14 +1031,183 @@ static zend_string* pthreads_store_restore_string(zend_string* string) {
 	return result;
 }
 
+/* {{{ Shared strings are immutable persistent strings owned by a single storage, which copies share through its own
+	refcount, e.g. after merge(). They must never be given to user code, which would refcount them non-atomically */
+static pthreads_storage* pthreads_store_create_shared_string(zend_string* string, uint64_t serial) {
+	pthreads_shared_string_storage_t* storage = pthreads_slab_alloc(sizeof(pthreads_shared_string_storage_t));
+	if (storage == NULL) {
+		return NULL;
+	}
+	storage->common.type = STORE_TYPE_SHARED_STRING;
+	storage->common.refcount = 1;
+	storage->common.serial = serial;
+	storage->string = string;
+	return (pthreads_storage*) storage;
+} /* }}} */
+
+/* {{{ Converts a string storage to a shared string in place, without changing its value */
+static void pthreads_store_promote_string(zval* zstorage) {
+	pthreads_string_storage_t* string = (pthreads_string_storage_t*) Z_PTR_P(zstorage);
+	pthreads_storage* shared = pthreads_store_create_shared_string(
+		zend_string_init(ZSTR_VAL(string->string), ZSTR_LEN(string->string), 1),
+		string->common.serial
+	);
+
+	if (shared != NULL) {
+		pthreads_store_storage_dtor(zstorage);
+		ZVAL_PTR(zstorage, shared);
+	}
+} /* }}} */
+
+/* {{{ */
+static void pthreads_store_free_array(HashTable* array) {
+	zend_hash_destroy(array);
+	free(array);
+} /* }}} */
+
+/* {{{ */
+static void pthreads_store_array_element_dtor(zval* element) {
+	switch (Z_TYPE_P(element)) {
+		case IS_STRING:
+			zend_string_release_ex(Z_STR_P(element), 1);
+			break;
+		case IS_ARRAY:
+			pthreads_store_free_array(Z_ARRVAL_P(element));
+			break;
+		default:
+			break;
+	}
+} /* }}} */
+
+/* {{{ Makes a persistent deep copy of an array containing only scalars, strings and other such arrays
+	Returns NULL if the array contains anything else (e.g. objects), or is recursive */
+static HashTable* pthreads_store_save_array(HashTable* source) {
+	HashTable* copy;
+	zend_ulong idx;
+	zend_string* name;
+	zval* value;
+	//immutable arrays can't be recursive, and our own persistent copies are never recursive
+	zend_bool protect = !(GC_FLAGS(source) & (GC_IMMUTABLE|GC_PERSISTENT));
+
+	if (protect) {
+		if (GC_IS_RECURSIVE(source)) {
+			return NULL;
+		}
+		GC_PROTECT_RECURSION(source);
+	}
+
+	copy = malloc(sizeof(HashTable));
+	if (copy == NULL) {
+		goto failure;
+	}
+	zend_hash_init(copy, zend_hash_num_elements(source), NULL, pthreads_store_array_element_dtor, 1);
+
+	ZEND_HASH_FOREACH_KEY_VAL_IND(source, idx, name, value) {
+		zval element;
+
+		ZVAL_DEREF(value);
+		switch (Z_TYPE_P(value)) {
+			case IS_NULL:
+			case IS_FALSE:
+			case IS_TRUE:
+			case IS_LONG:
+			case IS_DOUBLE:
+				ZVAL_COPY_VALUE(&element, value);
+				break;
+			case IS_STRING:
+				ZVAL_STR(&element, pthreads_store_save_string(Z_STR_P(value)));
+				break;
+			case IS_ARRAY: {
+				HashTable* nested = pthreads_store_save_array(Z_ARRVAL_P(value));
+				if (nested == NULL) {
+					goto failure;
+				}
+				ZVAL_ARR(&element, nested);
+			} break;
+			default:
+				goto failure;
+		}
+
+		if (!name) {
+			zend_hash_index_add_new(copy, idx, &element);
+		} else if (GC_FLAGS(name) & IS_STR_PERMANENT) {
+			zend_hash_add_new(copy, name, &element);
+		} else {
+			zend_hash_str_add_new(copy, ZSTR_VAL(name), ZSTR_LEN(name), &element);
+		}
+	} ZEND_HASH_FOREACH_END();
+	copy->nNextFreeElement = source->nNextFreeElement;
+
+	if (protect) {
+		GC_UNPROTECT_RECURSION(source);
+	}
+	return copy;
+
+failure:
+	if (protect) {
+		GC_UNPROTECT_RECURSION(source);
+	}
+	if (copy != NULL) {
+		pthreads_store_free_array(copy);
+	}
+	return NULL;
+} /* }}} */
+
+/* {{{ Materializes a thread-local copy of an array made by pthreads_store_save_array() */
+static void pthreads_store_restore_array(zval* unstore, HashTable* source) {
+	HashTable* copy;
+	zend_ulong idx;
+	zend_string* name;
+	zval* value;
+
+	if (zend_hash_num_elements(source) == 0) {
+		ZVAL_EMPTY_ARRAY(unstore);
+		return;
+	}
+
+	array_init_size(unstore, zend_hash_num_elements(source));
+	copy = Z_ARRVAL_P(unstore);
+
+	ZEND_HASH_FOREACH_KEY_VAL(source, idx, name, value) {
+		zval element;
+
+		switch (Z_TYPE_P(value)) {
+			case IS_STRING:
+				ZVAL_STR(&element, pthreads_store_restore_string(Z_STR_P(value)));
+				break;
+			case IS_ARRAY:
+				pthreads_store_restore_array(&element, Z_ARRVAL_P(value));
+				break;
+			default:
+				ZVAL_COPY_VALUE(&element, value);
+				break;
+		}
+
+		if (!name) {
+			zend_hash_index_add_new(copy, idx, &element);
+		} else if (GC_FLAGS(name) & IS_STR_PERMANENT) {
+			zend_hash_add_new(copy, name, &element);
+		} else {
+			zend_hash_str_add_new(copy, ZSTR_VAL(name), ZSTR_LEN(name), &element);
+		}
+	} ZEND_HASH_FOREACH_END();
+	copy->nNextFreeElement = source->nNextFreeElement;
+} /* }}} */
+
 /* {{{ */
 int pthreads_store_write(zend_object *object, zval *key, zval *write, zend_bool coerce_array_to_threaded) {
+	return pthreads_store_write_ex(object, key, PTHREADS_STORE_NO_SLOT, write, coerce_array_to_threaded);
+} /* }}} */
+
+/* {{{ */
+int pthreads_store_write_ex(zend_object *object, zval *key, uint32_t slot, zval *write, zend_bool coerce_array_to_threaded) {
 	int result = FAILURE;
 	zval vol, member, zstorage;
 	pthreads_zend_object_t *threaded =
 		PTHREADS_FETCH_FROM(object);
 	pthreads_object_t *ts_obj = threaded->ts_obj;
 	zend_bool coerced = 0;
+	uint64_t serial = 0;
 
 	if (Z_TYPE_P(write) == IS_ARRAY && coerce_array_to_threaded == PTHREADS_STORE_COERCE_ARRAY) {
 		/* coerce arrays into threaded objects */
@@ -514,6 +1223,10 @@ int pthreads_store_write(zend_object *object, zval *key, zval *write, zend_bool
 		zend_throw_error(zend_ce_error, "Unsupported data type %s", zend_get_type_by_const(Z_TYPE_P(write)));
 		return FAILURE;
 	}
+	if (TRY_PTHREADS_STORAGE_PTR_P(&zstorage) != NULL && TRY_PTHREADS_STORAGE_PTR_P(&zstorage)->type == STORE_TYPE_INLINE_STRING) {
+		//the string written is identical to the stored copy, so it can be cached as if it was restored from it
+		serial = TRY_PTHREADS_STORAGE_PTR_P(&zstorage)->serial;
+	}
 
 	if (pthreads_monitor_lock(&ts_obj->monitor)) {
 		if (!key) {
@@ -524,11 +1237,7 @@ int pthreads_store_write(zend_object *object, zval *key, zval *write, zend_bool
 			coerced = pthreads_store_coerce(key, &member);
 		}
 
-		zend_bool was_pthreads_object = pthreads_store_member_is_cacheable(object, &member);
-		result = pthreads_store_update_shared_property(ts_obj, &member, &zstorage);
-		if (result == SUCCESS && was_pthreads_object) {
-			_pthreads_store_bump_modcount_nolock(threaded);
-		}
+		result = pthreads_store_replace_nolock(threaded, &member, slot, &zstorage);
 		//this isn't necessary for any specific property write, but since we don't have any other way to clean up local
 		//cached Threaded references that are dead, we have to take the opportunity
 		pthreads_store_sync_local_properties(object);
@@ -539,7 +1248,202 @@ int pthreads_store_write(zend_object *object, zval *key, zval *write, zend_bool
 	if (result != SUCCESS) {
 		pthreads_store_storage_dtor(&zstorage);
 	} else {
-		pthreads_store_update_local_property(&threaded->std, &member, write);
+		//arrays written by this thread aren't cached, since they may contain references which would make the cached copy diverge
+		pthreads_store_update_local_property(&threaded->std, &member, write, serial);
+	}
+
+	if (coerced)
+		zval_ptr_dtor(&member);
+
+	return result;
+} /* }}} */
+
+/* {{{ Converts a stored member to a number for increment(), as ++ would: null counts as 0, and numeric strings are
+	converted; returns 0 if the member can't be incremented */
+static zend_bool pthreads_store_storage_to_number(zval *zstorage, zval *number) {
+	pthreads_storage *storage = TRY_PTHREADS_STORAGE_PTR_P(zstorage);
+	zend_long lval;
+	double dval;
+	zval restored;
+
+	switch (Z_TYPE_P(zstorage)) {
+		case IS_NULL:
+			ZVAL_LONG(number, 0);
+			return 1;
+
+		case IS_LONG:
+		case IS_DOUBLE:
+			//numbers are stored directly, so there's nothing to restore
+			ZVAL_COPY_VALUE(number, zstorage);
+			return 1;
+	}
+
+	if (storage == NULL || (
+		storage->type != STORE_TYPE_STRING_PTR &&
+		storage->type != STORE_TYPE_SHARED_STRING &&
+		storage->type != STORE_TYPE_INLINE_STRING
+	)) {
+		return 0;
+	}
+
+	pthreads_store_restore_zval(&restored, zstorage);
+	switch (is_numeric_string(Z_STRVAL(restored), Z_STRLEN(restored), &lval, &dval, 0)) {
+		case IS_LONG:
+			ZVAL_LONG(number, lval);
+			break;
+		case IS_DOUBLE:
+			ZVAL_DOUBLE(number, dval);
+			break;
+		default:
+			ZVAL_UNDEF(number);
+	}
+	zval_ptr_dtor(&restored);
+
+	return !Z_ISUNDEF_P(number);
+} /* }}} */
+
+/* {{{ */
+int pthreads_store_increment(zend_object *object, zval *key, uint32_t slot, zend_property_info *info, zval *delta, zend_bool strict, zval *result) {
+	int status = FAILURE;
+	zval member;
+	pthreads_zend_object_t *threaded = PTHREADS_FETCH_FROM(object);
+	pthreads_object_t *ts_obj = threaded->ts_obj;
+	zend_bool coerced = pthreads_store_coerce(key, &member);
+
+	if (pthreads_monitor_lock(&ts_obj->monitor)) {
+		zval *zstorage = pthreads_store_find(&ts_obj->props, &member, slot);
+		zval current;
+
+		ZVAL_UNDEF(&current);
+		if (zstorage == NULL && info != NULL && ZEND_TYPE_IS_SET(info->type)) {
+			//typed properties are only missing from the store until they're initialized
+			zend_throw_error(NULL, "Typed property %s::$%s must not be accessed before initialization",
+				ZSTR_VAL(info->ce->name), zend_get_unmangled_property_name(info->name));
+		} else if (zstorage == NULL) {
+			ZVAL_LONG(&current, 0);
+		} else if (!pthreads_store_storage_to_number(zstorage, &current)) {
+			zend_type_error("Cannot increment non-numeric member of %s", ZSTR_VAL(object->ce->name));
+		}
+
+		if (!Z_ISUNDEF(current)) {
+			add_function(result, &current, delta);
+
+			//the result is only known under the lock, so it can't be checked by the caller; it may be coerced to the type
+			if (info == NULL || !ZEND_TYPE_IS_SET(info->type) || zend_verify_property_type(info, result, strict)) {
+				zval zstorage;
+
+				//coercion may have made it a string, which must be stored like any other written value
+				if (pthreads_store_save_zval(&threaded->owner, &zstorage, result) != SUCCESS) {
+					zend_throw_error(zend_ce_error, "Unsupported data type %s", zend_get_type_by_const(Z_TYPE_P(result)));
+				} else {
+					status = pthreads_store_replace_nolock(threaded, &member, slot, &zstorage);
+					if (status != SUCCESS) {
+						pthreads_store_storage_dtor(&zstorage);
+					}
+				}
+			}
+		}
+
+		pthreads_monitor_unlock(&ts_obj->monitor);
+	}
+
+	if (status == SUCCESS) {
+		pthreads_store_update_local_property(&threaded->std, &member, result, 0);
+	} else {
+		zval_ptr_dtor(result);
+		ZVAL_UNDEF(result);
+	}
+
+	if (coerced)
+		zval_ptr_dtor(&member);
+
+	return status;
+} /* }}} */
+
+/* {{{ */
+int pthreads_store_compare_and_set(zend_object *object, zval *key, uint32_t slot, zval *expected, zval *value) {
+	int result = FAILURE;
+	zval member, zstorage;
+	pthreads_zend_object_t *threaded = PTHREADS_FETCH_FROM(object);
+	pthreads_object_t *ts_obj = threaded->ts_obj;
+	zend_bool coerced;
+
+	if (pthreads_store_save_zval(&threaded->owner, &zstorage, value) != SUCCESS) {
+		zend_throw_error(zend_ce_error, "Unsupported data type %s", zend_get_type_by_const(Z_TYPE_P(value)));
+		return FAILURE;
+	}
+
+	coerced = pthreads_store_coerce(key, &member);
+
+	if (pthreads_monitor_lock(&ts_obj->monitor)) {
+		zval *current = pthreads_store_find(&ts_obj->props, &member, slot);
+		zend_bool identical;
+
+		if (current == NULL) {
+			//an undefined member reads as null
+			identical = Z_TYPE_P(expected) == IS_NULL;
+		} else if (Z_TYPE_P(current) != IS_PTR) {
+			identical = fast_is_identical_function(current, expected);
+		} else {
+			zval restored;
+			pthreads_store_restore_zval(&restored, current);
+			identical = fast_is_identical_function(&restored, expected);
+			zval_ptr_dtor(&restored);
+		}
+
+		if (identical) {
+			result = pthreads_store_replace_nolock(threaded, &member, slot, &zstorage);
+			pthreads_store_sync_local_properties(object);
+		}
+
+		pthreads_monitor_unlock(&ts_obj->monitor);
+	}
+
+	if (result != SUCCESS) {
+		pthreads_store_storage_dtor(&zstorage);
+	} else {
+		pthreads_store_update_local_property(&threaded->std, &member, value, 0);
+	}
+
+	if (coerced)
+		zval_ptr_dtor(&member);
+
+	return result;
+} /* }}} */
+
+/* {{{ */
+int pthreads_store_fetch_and_set(zend_object *object, zval *key, uint32_t slot, zval *value, zval *previous) {
+	int result = FAILURE;
+	zval member, zstorage;
+	pthreads_zend_object_t *threaded = PTHREADS_FETCH_FROM(object);
+	pthreads_object_t *ts_obj = threaded->ts_obj;
+	zend_bool coerced;
+
+	if (pthreads_store_save_zval(&threaded->owner, &zstorage, value) != SUCCESS) {
+		zend_throw_error(zend_ce_error, "Unsupported data type %s", zend_get_type_by_const(Z_TYPE_P(value)));
+		return FAILURE;
+	}
+
+	coerced = pthreads_store_coerce(key, &member);
+
+	ZVAL_NULL(previous);
+	if (pthreads_monitor_lock(&ts_obj->monitor)) {
+		zval *current = pthreads_store_find(&ts_obj->props, &member, slot);
+
+		if (current != NULL) {
+			pthreads_store_restore_zval(previous, current);
+		}
+
+		result = pthreads_store_replace_nolock(threaded, &member, slot, &zstorage);
+		pthreads_store_sync_local_properties(object);
+
+		pthreads_monitor_unlock(&ts_obj->monitor);
+	}
+
+	if (result != SUCCESS) {
+		pthreads_store_storage_dtor(&zstorage);
+	} else {
+		pthreads_store_update_local_property(&threaded->std, &member, value, 0);
 	}
 
 	if (coerced)
@@ -552,48 +1456,354 @@ int pthreads_store_write(zend_object *object, zval *key, zval *write, zend_bool
 int pthreads_store_count(zend_object *object, zend_long *count) {
 	pthreads_object_t* ts_obj = PTHREADS_FETCH_TS_FROM(object);
 
+	//no need to lock, this is always published by writers before they release the monitor
+	(*count) = pthreads_atomic_load_u32(&ts_obj->props.count);
+
+	return SUCCESS;
+} /* }}} */
+
+/* {{{ */
+int pthreads_store_shift(zend_object *object, zval *member) {
+	pthreads_zend_object_t* threaded = PTHREADS_FETCH_FROM(object);
+	pthreads_object_t *ts_obj = threaded->ts_obj;
+
+	if (pthreads_monitor_lock(&ts_obj->monitor)) {
+		zval key;
+		HashPosition position;
+		zval *zstorage;
+
+		zend_hash_internal_pointer_reset_ex(&ts_obj->props.hash, &position);
+		if ((zstorage = zend_hash_get_current_data_ex(&ts_obj->props.hash, &position))) {
+			zend_hash_get_current_key_zval_ex(&ts_obj->props.hash, &key, &position);
+			zend_bool was_pthreads_object;
+
+			pthreads_store_restore_zval_ex(member, zstorage, &was_pthreads_object);
+			if (Z_TYPE(key) == IS_LONG) {
+				zend_hash_index_del(&ts_obj->props.hash, Z_LVAL(key));
+				if (threaded->std.properties) {
+					zend_hash_index_del(threaded->std.properties, Z_LVAL(key));
+				}
+			} else {
+				zend_hash_del(&ts_obj->props.hash, Z_STR(key));
+				pthreads_store_publish_scalar(&ts_obj->props, &key, NULL);
+				if (threaded->std.properties) {
+					zend_hash_del(threaded->std.properties, Z_STR(key));
+				}
+			}
+			pthreads_store_publish_changes(ts_obj);
+
+			if (was_pthreads_object) {
+				_pthreads_store_bump_modcount_nolock(threaded, &key);
+			}
+			zval_ptr_dtor(&key);
+			//TODO: maybe we should be syncing local properties here?
+		} else ZVAL_NULL(member);
+		pthreads_monitor_unlock(&ts_obj->monitor);
+
+		return SUCCESS;
+	}
+
+	return FAILURE;
+} /* }}} */
+
+/* {{{ */
+int pthreads_store_chunk(zend_object *object, zend_long size, zend_bool preserve, zval *chunk) {
+	pthreads_zend_object_t* threaded = PTHREADS_FETCH_FROM(object);
+	pthreads_object_t *ts_obj = threaded->ts_obj;
+
 	if (pthreads_monitor_lock(&ts_obj->monitor)) {
-		(*count) = zend_hash_num_elements(&ts_obj->props.hash);
+		HashTable *ht = &ts_obj->props.hash;
+		HashPosition position;
+		zval *zstorage;
+		zend_long counted = 0;
+		uint32_t changed = 0;
+
+		//logging each removed member is only worth copying their keys if the change log can hold all of them
+		for (zend_hash_internal_pointer_reset_ex(ht, &position);
+			counted < size && changed <= PTHREADS_STORE_CHANGELOG_SIZE &&
+			(zstorage = zend_hash_get_current_data_ex(ht, &position));
+			zend_hash_move_forward_ex(ht, &position), counted++) {
+			if (pthreads_store_storage_is_cacheable(zstorage)) {
+				changed++;
+			}
+		}
+
+		array_init(chunk);
+		zend_hash_internal_pointer_reset_ex(ht, &position);
+		while((zend_hash_num_elements(Z_ARRVAL_P(chunk)) < size) &&
+			(zstorage = zend_hash_get_current_data_ex(ht, &position))) {
+			zval key, zv;
+
+			zend_hash_get_current_key_zval_ex(ht, &key, &position);
+			//move on before the element is deleted, so that we don't have to walk over the holes again to find the next one
+			zend_hash_move_forward_ex(ht, &position);
+
+			zend_bool was_pthreads_object;
+			pthreads_store_restore_zval_ex(&zv, zstorage, &was_pthreads_object);
+			if (was_pthreads_object && changed <= PTHREADS_STORE_CHANGELOG_SIZE) {
+				_pthreads_store_bump_modcount_nolock(threaded, &key);
+			}
+			if (Z_TYPE(key) == IS_LONG) {
+				zend_hash_index_update(
+					Z_ARRVAL_P(chunk), Z_LVAL(key), &zv);
+				zend_hash_index_del(ht, Z_LVAL(key));
+				if (threaded->std.properties) {
+					zend_hash_index_del(threaded->std.properties, Z_LVAL(key));
+				}
+			} else {
+				/* we can't use zend_hash_update() here - the string from store.props must not be returned to user code */
+				zend_hash_str_update(
+					Z_ARRVAL_P(chunk), Z_STRVAL(key), Z_STRLEN(key), &zv);
+				zend_hash_del(ht, Z_STR(key));
+				pthreads_store_publish_scalar(&ts_obj->props, &key, NULL);
+				if (threaded->std.properties) {
+					zend_hash_del(threaded->std.properties, Z_STR(key));
+				}
+				zend_string_release(Z_STR(key));
+			}
+		}
+
+		pthreads_store_publish_changes(ts_obj);
+		if (changed > PTHREADS_STORE_CHANGELOG_SIZE) {
+			//too many to log, so a single unattributed change makes other threads rescan their caches instead
+			_pthreads_store_bump_modcount_nolock(threaded, NULL);
+		}
+
+		if (ht->nNumUsed - ht->nNumOfElements > MAX(ht->nNumOfElements, 8)) {
+			//deleted elements are only reclaimed when the table grows, so a table used as a queue would otherwise have
+			//to skip over all of the holes at the start every time; slot hints are validated, so it's safe to move things
+			if (HT_FLAGS(ht) & HASH_FLAG_PACKED) {
+				zend_hash_packed_to_hash(ht);
+			} else {
+				zend_hash_rehash(ht);
+			}
+		}
+
+		pthreads_store_sync_local_properties(object);
 		pthreads_monitor_unlock(&ts_obj->monitor);
-	} else (*count) = 0L;
 
-	return SUCCESS;
+		return SUCCESS;
+	}
+
+	return FAILURE;
+} /* }}} */
+
+/* {{{ */
+int pthreads_store_pop(zend_object *object, zval *member) {
+	pthreads_zend_object_t* threaded = PTHREADS_FETCH_FROM(object);
+	pthreads_object_t *ts_obj = threaded->ts_obj;
+
+	if (pthreads_monitor_lock(&ts_obj->monitor)) {
+		zval key;
+		HashPosition position;
+		zval *zstorage;
+
+		zend_hash_internal_pointer_end_ex(&ts_obj->props.hash, &position);
+		if ((zstorage = zend_hash_get_current_data_ex(&ts_obj->props.hash, &position))) {
+			zend_hash_get_current_key_zval_ex(&ts_obj->props.hash, &key, &position);
+
+			zend_bool was_pthreads_object;
+			pthreads_store_restore_zval_ex(member, zstorage, &was_pthreads_object);
+
+			if (Z_TYPE(key) == IS_LONG) {
+				zend_hash_index_del(
+					&ts_obj->props.hash, Z_LVAL(key));
+				if (threaded->std.properties) {
+					zend_hash_index_del(threaded->std.properties, Z_LVAL(key));
+				}
+			} else {
+				zend_hash_del(
+					&ts_obj->props.hash, Z_STR(key));
+				pthreads_store_publish_scalar(&ts_obj->props, &key, NULL);
+				if (threaded->std.properties) {
+					zend_hash_del(threaded->std.properties, Z_STR(key));
+				}
+			}
+			pthreads_store_publish_changes(ts_obj);
+			if (was_pthreads_object) {
+				_pthreads_store_bump_modcount_nolock(threaded, &key);
+			}
+			zval_ptr_dtor(&key);
+			//TODO: sync local properties?
+		} else ZVAL_NULL(member);
+
+		pthreads_monitor_unlock(&ts_obj->monitor);
+
+		return SUCCESS;
+	}
+
+   return FAILURE;
+} /* }}} */
+
+/* {{{ Grows the ring to twice its size, moving the items to the start of the new buffer */
+static zend_bool pthreads_store_ring_grow(pthreads_store_ring_t* ring) {
+	uint32_t size = ring->size ? ring->size * 2 : 8;
+	uint32_t first;
+	zval *items;
+
+	if (size < ring->size) {
+		return 0;
+	}
+
+	items = malloc(sizeof(zval) * size);
+	if (items == NULL) {
+		return 0;
+	}
+
+	if (ring->count > 0) {
+		first = MIN(ring->count, ring->size - ring->head);
+		memcpy(items, &ring->items[ring->head], sizeof(zval) * first);
+		memcpy(&items[first], ring->items, sizeof(zval) * (ring->count - first));
+	}
+	if (ring->items != NULL) {
+		free(ring->items);
+	}
+
+	ring->items = items;
+	ring->size = size;
+	ring->head = 0;
+
+	return 1;
+} /* }}} */
+
+/* {{{ */
+int pthreads_store_ring_set_capacity(zend_object *object, zend_long capacity) {
+	pthreads_object_t *ts_obj = PTHREADS_FETCH_TS_FROM(object);
+
+	if (pthreads_monitor_lock(&ts_obj->monitor)) {
+		ts_obj->props.ring->capacity = capacity;
+		pthreads_monitor_unlock(&ts_obj->monitor);
+
+		return SUCCESS;
+	}
+
+	return FAILURE;
+} /* }}} */
+
+/* {{{ */
+int pthreads_store_ring_push(zend_object *object, zval *value) {
+	int result = FAILURE;
+	zval zstorage;
+	pthreads_zend_object_t *threaded = PTHREADS_FETCH_FROM(object);
+	pthreads_object_t *ts_obj = threaded->ts_obj;
+
+	if (pthreads_store_save_zval(&threaded->owner, &zstorage, value) != SUCCESS) {
+		zend_throw_error(zend_ce_error, "Unsupported data type %s", zend_get_type_by_const(Z_TYPE_P(value)));
+		return FAILURE;
+	}
+
+	if (TRY_PTHREADS_STORAGE_PTR_P(&zstorage) != NULL && TRY_PTHREADS_STORAGE_PTR_P(&zstorage)->type == STORE_TYPE_STRING_PTR) {
+		//items are usually consumed by other threads, so this thread's copy of the string is of no use to anyone;
+		//a persistent copy also means we don't need to persist items when this thread's ref to the queue dies
+		pthreads_store_promote_string(&zstorage);
+	}
+
+	if (pthreads_monitor_lock(&ts_obj->monitor)) {
+		pthreads_store_ring_t *ring = ts_obj->props.ring;
+
+		if (
+			(ring->capacity == 0 || ring->count < ring->capacity) &&
+			(ring->count < ring->size || pthreads_store_ring_grow(ring))
+		) {
+			ZVAL_COPY_VALUE(&ring->items[(ring->head + ring->count) & (ring->size - 1)], &zstorage);
+			pthreads_atomic_store_u32(&ring->count, ring->count + 1);
+			result = SUCCESS;
+
+			if (ring->waiters > 0) {
+				pthreads_monitor_notify_ex(&ts_obj->monitor, PTHREADS_MONITOR_QUEUE_ITEMS, NULL, 0);
+			}
+			if (ts_obj->props.waiters > 0) {
+				pthreads_monitor_notify_ex(&ts_obj->monitor, PTHREADS_MONITOR_QUEUE_MEMBERS, NULL, 1);
+			}
+		}
+
+		pthreads_monitor_unlock(&ts_obj->monitor);
+	}
+
+	if (result != SUCCESS) {
+		pthreads_store_storage_dtor(&zstorage);
+	}
+
+	return result;
+} /* }}} */
+
+/* {{{ */
+static zend_bool pthreads_store_ring_wait(pthreads_object_t *ts_obj, zend_long timeout) {
+	pthreads_store_ring_t *ring = ts_obj->props.ring;
+	uint64_t deadline = 0;
+
+	if (timeout < 0) {
+		return 0;
+	}
+	if (timeout > 0) {
+		//the timeout is in microseconds
+		deadline = pthreads_monitor_clock_ns() + MIN((uint64_t) timeout, PTHREADS_MONITOR_WAIT_MAX / 1000) * 1000;
+	}
+
+	ring->waiters++;
+	while (ring->count == 0) {
+		uint64_t remaining = 0;
+
+		if (deadline) {
+			uint64_t now = pthreads_monitor_clock_ns();
+
+			if (now >= deadline) {
+				break;
+			}
+			remaining = deadline - now;
+		}
+
+		//another thread may have taken the item we were woken for, in which case we just loop back around
+		if (pthreads_monitor_wait_ex(&ts_obj->monitor, remaining, PTHREADS_MONITOR_QUEUE_ITEMS, NULL) != 0) {
+			break;
+		}
+	}
+	ring->waiters--;
+
+	return ring->count > 0;
+} /* }}} */
+
+/* {{{ */
+int pthreads_store_ring_shift(zend_object *object, zend_long timeout, zval *member) {
+	pthreads_object_t *ts_obj = PTHREADS_FETCH_TS_FROM(object);
+
+	if (pthreads_monitor_lock(&ts_obj->monitor)) {
+		pthreads_store_ring_t *ring = ts_obj->props.ring;
+
+		if (ring->count > 0 || pthreads_store_ring_wait(ts_obj, timeout)) {
+			zval *zstorage = &ring->items[ring->head];
+
+			pthreads_store_restore_zval(member, zstorage);
+			pthreads_store_storage_dtor(zstorage);
+
+			ring->head = (ring->head + 1) & (ring->size - 1);
+			pthreads_atomic_store_u32(&ring->count, ring->count - 1);
+		} else ZVAL_NULL(member);
+
+		pthreads_monitor_unlock(&ts_obj->monitor);
+
+		return SUCCESS;
+	}
+
+	return FAILURE;
 } /* }}} */
 
 /* {{{ */
-int pthreads_store_shift(zend_object *object, zval *member) {
-	pthreads_zend_object_t* threaded = PTHREADS_FETCH_FROM(object);
-	pthreads_object_t *ts_obj = threaded->ts_obj;
+int pthreads_store_ring_pop(zend_object *object, zval *member) {
+	pthreads_object_t *ts_obj = PTHREADS_FETCH_TS_FROM(object);
 
 	if (pthreads_monitor_lock(&ts_obj->monitor)) {
-		zval key;
-		HashPosition position;
-		zval *zstorage;
+		pthreads_store_ring_t *ring = ts_obj->props.ring;
 
-		zend_hash_internal_pointer_reset_ex(&ts_obj->props.hash, &position);
-		if ((zstorage = zend_hash_get_current_data_ex(&ts_obj->props.hash, &position))) {
-			zend_hash_get_current_key_zval_ex(&ts_obj->props.hash, &key, &position);
-			zend_bool was_pthreads_object;
+		if (ring->count > 0) {
+			zval *zstorage = &ring->items[(ring->head + ring->count - 1) & (ring->size - 1)];
 
-			pthreads_store_restore_zval_ex(member, zstorage, &was_pthreads_object);
-			if (Z_TYPE(key) == IS_LONG) {
-				zend_hash_index_del(&ts_obj->props.hash, Z_LVAL(key));
-				if (threaded->std.properties) {
-					zend_hash_index_del(threaded->std.properties, Z_LVAL(key));
-				}
-			} else {
-				zend_hash_del(&ts_obj->props.hash, Z_STR(key));
-				if (threaded->std.properties) {
-					zend_hash_del(threaded->std.properties, Z_STR(key));
-				}
-				zend_string_release(Z_STR(key));
-			}
+			pthreads_store_restore_zval(member, zstorage);
+			pthreads_store_storage_dtor(zstorage);
 
-			if (was_pthreads_object) {
-				_pthreads_store_bump_modcount_nolock(threaded);
-			}
-			//TODO: maybe we should be syncing local properties here?
+			pthreads_atomic_store_u32(&ring->count, ring->count - 1);
 		} else ZVAL_NULL(member);
+
 		pthreads_monitor_unlock(&ts_obj->monitor);
 
 		return SUCCESS;
@@ -603,103 +1813,158 @@ int pthreads_store_shift(zend_object *object, zval *member) {
 } /* }}} */
 
 /* {{{ */
-int pthreads_store_chunk(zend_object *object, zend_long size, zend_bool preserve, zval *chunk) {
-	pthreads_zend_object_t* threaded = PTHREADS_FETCH_FROM(object);
-	pthreads_object_t *ts_obj = threaded->ts_obj;
+int pthreads_store_ring_count(zend_object *object, zend_long *count) {
+	pthreads_object_t *ts_obj = PTHREADS_FETCH_TS_FROM(object);
 
-	if (pthreads_monitor_lock(&ts_obj->monitor)) {
-		HashPosition position;
-		zval *zstorage;
+	//no need to lock, this is always published by writers before they release the monitor
+	(*count) = pthreads_atomic_load_u32(&ts_obj->props.ring->count);
 
-		array_init(chunk);
-		zend_hash_internal_pointer_reset_ex(&ts_obj->props.hash, &position);
-		zend_bool removed_pthreads_object = 0;
-		while((zend_hash_num_elements(Z_ARRVAL_P(chunk)) < size) &&
-			(zstorage = zend_hash_get_current_data_ex(&ts_obj->props.hash, &position))) {
-			zval key, zv;
+	return SUCCESS;
+} /* }}} */
 
-			zend_hash_get_current_key_zval_ex(&ts_obj->props.hash, &key, &position);
+/* {{{ Tells if a stored value is identical (===) to expected, without restoring it where possible */
+static zend_bool pthreads_store_storage_is_identical(zval *zstorage, zval *expected) {
+	pthreads_storage *storage = TRY_PTHREADS_STORAGE_PTR_P(zstorage);
+	zend_bool identical;
+	zval restored;
 
-			zend_bool was_pthreads_object;
-			pthreads_store_restore_zval_ex(&zv, zstorage, &was_pthreads_object);
-			if (!removed_pthreads_object) {
-				removed_pthreads_object = was_pthreads_object;
-			}
-			if (Z_TYPE(key) == IS_LONG) {
-				zend_hash_index_update(
-					Z_ARRVAL_P(chunk), Z_LVAL(key), &zv);
-				zend_hash_index_del(&ts_obj->props.hash, Z_LVAL(key));
-				if (threaded->std.properties) {
-					zend_hash_index_del(threaded->std.properties, Z_LVAL(key));
-				}
-			} else {
-				/* we can't use zend_hash_update() here - the string from store.props must not be returned to user code */
-				zend_hash_str_update(
-					Z_ARRVAL_P(chunk), Z_STRVAL(key), Z_STRLEN(key), &zv);
-				zend_hash_del(&ts_obj->props.hash, Z_STR(key));
-				if (threaded->std.properties) {
-					zend_hash_del(threaded->std.properties, Z_STR(key));
-				}
-				zend_string_release(Z_STR(key));
-			}
+	if (zstorage == NULL) {
+		//an undefined member reads as null
+		return Z_TYPE_P(expected) == IS_NULL;
+	}
+	if (storage == NULL) {
+		return fast_is_identical_function(zstorage, expected);
+	}
 
-			zend_hash_internal_pointer_reset_ex(&ts_obj->props.hash, &position);
+	switch (storage->type) {
+		case STORE_TYPE_STRING_PTR:
+		case STORE_TYPE_SHARED_STRING: {
+			zend_string *string = storage->type == STORE_TYPE_STRING_PTR ?
+				((pthreads_string_storage_t*) storage)->string : ((pthreads_shared_string_storage_t*) storage)->string;
+
+			return Z_TYPE_P(expected) == IS_STRING && zend_string_equal_content(string, Z_STR_P(expected));
 		}
-		if (removed_pthreads_object) {
-			_pthreads_store_bump_modcount_nolock(threaded);
+
+		case STORE_TYPE_INLINE_STRING: {
+			pthreads_inline_string_storage_t *string = (pthreads_inline_string_storage_t*) storage;
+
+			return Z_TYPE_P(expected) == IS_STRING &&
+				Z_STRLEN_P(expected) == string->length &&
+				memcmp(Z_STRVAL_P(expected), string->value, string->length) == 0;
 		}
-		//TODO: sync local properties?
-		pthreads_monitor_unlock(&ts_obj->monitor);
 
-		return SUCCESS;
+		default:
+			break;
 	}
 
-	return FAILURE;
+	pthreads_store_restore_zval(&restored, zstorage);
+	identical = fast_is_identical_function(&restored, expected);
+	zval_ptr_dtor(&restored);
+
+	return identical;
+} /* }}} */
+
+/* {{{ Tells if a stored value is set and not empty, as by !empty(), without restoring it */
+static zend_bool pthreads_store_storage_is_true(zval *zstorage) {
+	pthreads_storage *storage = TRY_PTHREADS_STORAGE_PTR_P(zstorage);
+
+	if (zstorage == NULL) {
+		return 0;
+	}
+	if (storage == NULL) {
+		return zend_is_true(zstorage);
+	}
+
+	switch (storage->type) {
+		case STORE_TYPE_STRING_PTR:
+		case STORE_TYPE_SHARED_STRING: {
+			zend_string *string = storage->type == STORE_TYPE_STRING_PTR ?
+				((pthreads_string_storage_t*) storage)->string : ((pthreads_shared_string_storage_t*) storage)->string;
+
+			return ZSTR_LEN(string) > 1 || (ZSTR_LEN(string) == 1 && ZSTR_VAL(string)[0] != '0');
+		}
+
+		case STORE_TYPE_INLINE_STRING: {
+			pthreads_inline_string_storage_t *string = (pthreads_inline_string_storage_t*) storage;
+
+			return string->length > 1 || (string->length == 1 && string->value[0] != '0');
+		}
+
+		case STORE_TYPE_ARRAY:
+			return zend_hash_num_elements(((pthreads_array_storage_t*) storage)->array) > 0;
+
+		default:
+			//objects, closures, resources and enum cases are always true
+			return 1;
+	}
+} /* }}} */
+
+/* {{{ Must be called with the monitor held */
+static zend_bool pthreads_store_condition_holds(pthreads_object_t *ts_obj, pthreads_store_condition_t condition, zval *member, uint32_t slot, zval *expected) {
+	switch (condition) {
+		case PTHREADS_STORE_CONDITION_IDENTICAL:
+			return pthreads_store_storage_is_identical(
+				pthreads_store_find(&ts_obj->props, member, slot), expected);
+
+		case PTHREADS_STORE_CONDITION_NOT_EMPTY:
+			return pthreads_store_storage_is_true(
+				pthreads_store_find(&ts_obj->props, member, slot));
+
+		case PTHREADS_STORE_CONDITION_COUNT:
+			if (ts_obj->props.ring != NULL) {
+				return (zend_long) ts_obj->props.ring->count >= Z_LVAL_P(expected);
+			}
+			return (zend_long) zend_hash_num_elements(&ts_obj->props.hash) >= Z_LVAL_P(expected);
+	}
+
+	return 0;
 } /* }}} */
 
 /* {{{ */
-int pthreads_store_pop(zend_object *object, zval *member) {
-	pthreads_zend_object_t* threaded = PTHREADS_FETCH_FROM(object);
-	pthreads_object_t *ts_obj = threaded->ts_obj;
+int pthreads_store_wait_until(zend_object *object, pthreads_store_condition_t condition, zval *key, uint32_t slot, zval *expected, uint64_t timeout) {
+	pthreads_object_t *ts_obj = PTHREADS_FETCH_TS_FROM(object);
+	zend_bool holds = 0;
+	zend_bool coerced = 0;
+	uint64_t deadline = 0;
+	zval member;
 
-	if (pthreads_monitor_lock(&ts_obj->monitor)) {
-		zval key;
-		HashPosition position;
-		zval *zstorage;
+	ZVAL_UNDEF(&member);
+	if (key != NULL) {
+		coerced = pthreads_store_coerce(key, &member);
+	}
+	if (timeout > 0) {
+		deadline = pthreads_monitor_clock_ns() + MIN(timeout, PTHREADS_MONITOR_WAIT_MAX);
+	}
 
-		zend_hash_internal_pointer_end_ex(&ts_obj->props.hash, &position);
-		if ((zstorage = zend_hash_get_current_data_ex(&ts_obj->props.hash, &position))) {
-			zend_hash_get_current_key_zval_ex(&ts_obj->props.hash, &key, &position);
+	if (pthreads_monitor_lock(&ts_obj->monitor)) {
+		ts_obj->props.waiters++;
+		while (!(holds = pthreads_store_condition_holds(ts_obj, condition, &member, slot, expected))) {
+			uint64_t remaining = 0;
 
-			zend_bool was_pthreads_object;
-			pthreads_store_restore_zval_ex(member, zstorage, &was_pthreads_object);
+			if (deadline) {
+				uint64_t now = pthreads_monitor_clock_ns();
 
-			if (Z_TYPE(key) == IS_LONG) {
-				zend_hash_index_del(
-					&ts_obj->props.hash, Z_LVAL(key));
-				if (threaded->std.properties) {
-					zend_hash_index_del(threaded->std.properties, Z_LVAL(key));
+				if (now >= deadline) {
+					break;
 				}
-			} else {
-				zend_hash_del(
-					&ts_obj->props.hash, Z_STR(key));
-				if (threaded->std.properties) {
-					zend_hash_del(threaded->std.properties, Z_STR(key));
-				}
-				zend_string_release(Z_STR(key));
+				remaining = deadline - now;
 			}
-			if (was_pthreads_object) {
-				_pthreads_store_bump_modcount_nolock(threaded);
+
+			//writers wake us on every change, most of which won't concern this condition, so we just check it again
+			if (pthreads_monitor_wait_ex(&ts_obj->monitor, remaining, PTHREADS_MONITOR_QUEUE_MEMBERS, NULL) != 0) {
+				holds = pthreads_store_condition_holds(ts_obj, condition, &member, slot, expected);
+				break;
 			}
-			//TODO: sync local properties?
-		} else ZVAL_NULL(member);
+		}
+		ts_obj->props.waiters--;
 
 		pthreads_monitor_unlock(&ts_obj->monitor);
-
-		return SUCCESS;
 	}
 
-   return FAILURE;
+	if (coerced)
+		zval_ptr_dtor(&member);
+
+	return holds ? SUCCESS : FAILURE;
 } /* }}} */
 
 /* {{{ */
@@ -709,7 +1974,7 @@ void pthreads_store_tohash(zend_object *object, HashTable *hash) {
 
 	pthreads_store_init_local_properties(&threaded->std);
 
-	if (pthreads_monitor_lock(&ts_obj->monitor)) {
+	if (pthreads_monitor_lock_shared(&ts_obj->monitor)) {
 		zend_string *name = NULL;
 		zend_ulong idx;
 		zval *zstorage;
@@ -784,11 +2049,123 @@ void pthreads_store_tohash(zend_object *object, HashTable *hash) {
 		if (changed && hash == threaded->std.properties) {
 			//if this is the object's own properties table, we need to ensure that junk added here
 			//doesn't get incorrectly treated as gospel
-			threaded->local_props_modcount = ts_obj->props.modcount - 1;
+			pthreads_store_invalidate_local_properties(object);
 		}
 
-		pthreads_monitor_unlock(&ts_obj->monitor);
+		pthreads_monitor_unlock_shared(&ts_obj->monitor);
+	}
+} /* }}} */
+
+/* {{{ */
+void pthreads_store_snapshot(zend_object *object, HashTable *snapshot) {
+	pthreads_zend_object_t *threaded = PTHREADS_FETCH_FROM(object);
+	pthreads_object_t *ts_obj = threaded->ts_obj;
+
+	if (pthreads_monitor_lock_shared(&ts_obj->monitor)) {
+		zend_string *name;
+		zend_ulong idx;
+		zval *zstorage;
+
+		if (threaded->std.properties) {
+			pthreads_store_sync_local_properties(object);
+		}
+
+		ZEND_HASH_FOREACH_KEY_VAL(&ts_obj->props.hash, idx, name, zstorage) {
+			zval *cached = NULL;
+			zval pzval;
+
+			if (threaded->std.properties) {
+				cached = !name ?
+					zend_hash_index_find(threaded->std.properties, idx) :
+					zend_hash_find(threaded->std.properties, name);
+			}
+
+			if (cached && pthreads_store_valid_local_cache_item(cached)) {
+				//reuse cached refs, so that Threaded objects keep their identity
+				ZVAL_DEINDIRECT(cached);
+				ZVAL_COPY(&pzval, cached);
+			} else {
+				pthreads_store_restore_zval(&pzval, zstorage);
+				if (pthreads_store_retain_in_local_cache(&pzval)) {
+					pthreads_storage *storage = TRY_PTHREADS_STORAGE_PTR_P(zstorage);
+					zval key;
+
+					if (!name) {
+						ZVAL_LONG(&key, idx);
+					} else ZVAL_STR(&key, name);
+					//so that later reads and snapshots reuse the same refs
+					pthreads_store_update_local_property(object, &key, &pzval, storage != NULL ? storage->serial : 0);
+				}
+			}
+
+			if (!name) {
+				zend_hash_index_update(snapshot, idx, &pzval);
+			} else {
+				/* we can't use zend_hash_update() here - the string from store.props must not be returned to user code */
+				zend_hash_str_update(snapshot, ZSTR_VAL(name), ZSTR_LEN(name), &pzval);
+			}
+		} ZEND_HASH_FOREACH_END();
+
+		pthreads_monitor_unlock_shared(&ts_obj->monitor);
+	}
+} /* }}} */
+
+/* {{{ */
+static int pthreads_store_to_array_ex(zend_object *object, zval *array, HashTable *converting) {
+	pthreads_object_t *ts_obj = PTHREADS_FETCH_TS_FROM(object);
+	zval *member;
+	int result = SUCCESS;
+
+	//connections to the same ThreadedArray share ts_obj, so it identifies the array regardless of how it was reached
+	if (converting != NULL && !zend_hash_index_add_empty_element(converting, (zend_ulong) ts_obj)) {
+		zend_throw_error(NULL, "Cannot convert %s containing itself to array", ZSTR_VAL(object->ce->name));
+		return FAILURE;
+	}
+
+	array_init(array);
+	pthreads_store_snapshot(object, Z_ARRVAL_P(array));
+
+	if (converting != NULL) {
+		//nested arrays are converted after the lock on this one is released, so that monitors are never nested
+		ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(array), member) {
+			zval converted;
+
+			if (Z_TYPE_P(member) != IS_OBJECT || !IS_PTHREADS_THREADED_ARRAY(Z_OBJCE_P(member))) {
+				continue;
+			}
+
+			if (pthreads_store_to_array_ex(Z_OBJ_P(member), &converted, converting) != SUCCESS) {
+				result = FAILURE;
+				break;
+			}
+			zval_ptr_dtor(member);
+			ZVAL_COPY_VALUE(member, &converted);
+		} ZEND_HASH_FOREACH_END();
+
+		zend_hash_index_del(converting, (zend_ulong) ts_obj);
 	}
+
+	if (result != SUCCESS) {
+		zval_ptr_dtor(array);
+		ZVAL_UNDEF(array);
+	}
+	return result;
+} /* }}} */
+
+/* {{{ */
+int pthreads_store_to_array(zend_object *object, zval *array, zend_bool recursive) {
+	HashTable converting;
+	int result;
+
+	if (!recursive) {
+		return pthreads_store_to_array_ex(object, array, NULL);
+	}
+
+	zend_hash_init(&converting, 8, NULL, NULL, 0);
+	result = pthreads_store_to_array_ex(object, array, &converting);
+	zend_hash_destroy(&converting);
+
+	return result;
 } /* }}} */
 
 /* {{{ */
@@ -806,11 +2183,8 @@ void pthreads_store_persist_local_properties(zend_object* object) {
 				if (string->owner.ls == TSRMLS_CACHE) {
 					//we can't guarantee this string will continue to be available once we stop referencing it on this thread,
 					//so we must create a persistent copy now
-
-					zend_string* persistent_string = pthreads_store_save_string(string->string);
-					pthreads_store_storage_dtor(zstorage);
-
-					ZVAL_STR(zstorage, persistent_string);
+					//the value doesn't change, so the serial is kept to avoid invalidating other threads' caches
+					pthreads_store_promote_string(zstorage);
 				}
 			}
 		} ZEND_HASH_FOREACH_END();
@@ -829,20 +2203,45 @@ static pthreads_storage* pthreads_store_create(pthreads_ident_t* source, zval *u
 		return pthreads_store_create(source, &Z_REF_P(unstore)->val);
 
 #define MAKE_STORAGE(enum_type, struct_type) \
-	struct_type *storage = malloc(sizeof(struct_type)); \
+	struct_type *storage = pthreads_slab_alloc(sizeof(struct_type)); \
 	if (storage == NULL) { \
 		break; \
 	} \
 	storage->common.type = enum_type; \
+	storage->common.refcount = 1; \
+	storage->common.serial = pthreads_store_next_serial(); \
 	result = (pthreads_storage*) storage; \
 
 	switch(Z_TYPE_P(unstore)){
 		case IS_STRING: {
+			if (Z_STRLEN_P(unstore) <= PTHREADS_STORE_INLINE_STRING_MAX) {
+				MAKE_STORAGE(STORE_TYPE_INLINE_STRING, pthreads_inline_string_storage_t);
+				storage->length = (uint32_t) Z_STRLEN_P(unstore);
+				memcpy(storage->value, Z_STRVAL_P(unstore), Z_STRLEN_P(unstore));
+				break;
+			}
 			MAKE_STORAGE(STORE_TYPE_STRING_PTR, pthreads_string_storage_t);
 			storage->owner = *source;
 			storage->string = Z_STR_P(unstore);
 		} break;
 
+		case IS_ARRAY: {
+			HashTable* array = pthreads_store_save_array(Z_ARRVAL_P(unstore));
+			if (array == NULL) {
+				break;
+			}
+			pthreads_array_storage_t* storage = pthreads_slab_alloc(sizeof(pthreads_array_storage_t));
+			if (storage == NULL) {
+				pthreads_store_free_array(array);
+				break;
+			}
+			storage->common.type = STORE_TYPE_ARRAY;
+			storage->common.refcount = 1;
+			storage->common.serial = pthreads_store_next_serial();
+			storage->array = array;
+			result = (pthreads_storage*) storage;
+		} break;
+
 		case IS_RESOURCE: {
 			MAKE_STORAGE(STORE_TYPE_RESOURCE, pthreads_resource_storage_t);
 			storage->resource.original = Z_RES_P(unstore);
@@ -964,6 +2363,17 @@ static int pthreads_store_convert(pthreads_storage *storage, zval *pzval){
 				ZVAL_STR(pzval, pthreads_store_restore_string(string->string));
 			}
 		} break;
+		case STORE_TYPE_SHARED_STRING: {
+			//the string can't be given to user code directly, because its refcount is shared with other threads
+			ZVAL_STR(pzval, pthreads_store_restore_string(((pthreads_shared_string_storage_t*)storage)->string));
+		} break;
+		case STORE_TYPE_INLINE_STRING: {
+			pthreads_inline_string_storage_t* string = (pthreads_inline_string_storage_t*)storage;
+			ZVAL_STRINGL(pzval, string->value, string->length);
+		} break;
+		case STORE_TYPE_ARRAY: {
+			pthreads_store_restore_array(pzval, ((pthreads_array_storage_t*)storage)->array);
+		} break;
 		case STORE_TYPE_RESOURCE: {
 			pthreads_resource_storage_t *stored = (pthreads_resource_storage_t*) storage;
 
@@ -1121,35 +2531,22 @@ static void pthreads_store_hard_copy_storage(zval *new_zstorage, zval *zstorage)
 	if (Z_TYPE_P(zstorage) == IS_PTR) {
 		pthreads_storage *storage = (pthreads_storage *) Z_PTR_P(zstorage);
 		if (storage->type == STORE_TYPE_STRING_PTR) {
-			//hard-copy string ptrs here, since the destination object might not exist on the thread which owns the string
-			//this means that the owning thread may not be aware that this new ref now exists and won't persist the string when it dies
+			//the destination object might not exist on the thread which owns the string, so the owning thread may not be
+			//aware that this new ref now exists and won't persist the string when it dies
+			//instead, we convert the source to a shared string, which both objects can then reference without copying
+			pthreads_store_promote_string(zstorage);
+			storage = (pthreads_storage *) Z_PTR_P(zstorage);
+		}
+
+		if (storage->type == STORE_TYPE_STRING_PTR) {
+			//promotion failed, fall back to a private copy
 			pthreads_string_storage_t* string = (pthreads_string_storage_t*)storage;
 			ZVAL_STR(new_zstorage, pthreads_store_save_string(string->string));
-
 		} else {
-
-#define CASE_STORAGE(enum_type, struct_type) \
-				case enum_type: { \
-					struct_type* copy = malloc(sizeof(struct_type)); \
-					memcpy(copy, storage, sizeof(struct_type)); \
-					ZVAL_PTR(new_zstorage, copy); \
-				} break;
-
-			switch (storage->type) {
-				CASE_STORAGE(STORE_TYPE_CLOSURE, pthreads_closure_storage_t);
-				CASE_STORAGE(STORE_TYPE_PTHREADS, pthreads_zend_object_storage_t);
-				CASE_STORAGE(STORE_TYPE_RESOURCE, pthreads_resource_storage_t);
-#if HAVE_PTHREADS_EXT_SOCKETS_SUPPORT
-				CASE_STORAGE(STORE_TYPE_SOCKET, pthreads_socket_storage_t);
-#endif
-				CASE_STORAGE(STORE_TYPE_ENUM, pthreads_enum_storage_t); //TODO: we need to copy or intern these strings, otherwise UAF will occur
-				default: {
-					ZEND_ASSERT(0);
-					ZVAL_UNDEF(new_zstorage);
-				} break;
-			}
+			//everything else is immutable once stored, so the copy can share it until either side is overwritten
+			pthreads_atomic_fetch_add_u32(&storage->refcount, 1);
+			ZVAL_PTR(new_zstorage, storage);
 		}
-#undef CASE_STORAGE
 	} else if (Z_TYPE_P(zstorage) == IS_STRING) {
 		ZVAL_STR(new_zstorage, pthreads_store_save_string(Z_STR_P(zstorage)));
 	} else {
@@ -1176,7 +2573,23 @@ int pthreads_store_merge(zend_object *destination, zval *from, zend_bool overwri
 						zval *storage;
 						HashTable *tables[2] = {&threaded[0]->props.hash, &threaded[1]->props.hash};
 						zval key;
-						zend_bool overwrote_pthreads_object = 0;
+						uint32_t changed = 0;
+
+						if (overwrite) {
+							//only replaced members can be cached, and logging each of them is only worth copying their
+							//keys if the change log can hold all of them
+							zend_ulong idx;
+							zend_string *name;
+
+							ZEND_HASH_FOREACH_KEY(tables[1], idx, name) {
+								zval *replaced = name != NULL ? zend_hash_find(tables[0], name) : zend_hash_index_find(tables[0], idx);
+								if (pthreads_store_storage_is_cacheable(replaced) && ++changed > PTHREADS_STORE_CHANGELOG_SIZE) {
+									break;
+								}
+							} ZEND_HASH_FOREACH_END();
+						}
+
+						pthreads_store_reserve_packed(&threaded[0]->props, tables[1]);
 
 						for (zend_hash_internal_pointer_reset_ex(tables[1], &position);
 							 (storage = zend_hash_get_current_data_ex(tables[1], &position));
@@ -1195,8 +2608,8 @@ int pthreads_store_merge(zend_object *destination, zval *from, zend_bool overwri
 								}
 							}
 
-							if (!overwrote_pthreads_object) {
-								overwrote_pthreads_object = pthreads_store_member_is_cacheable(destination, &key);
+							if (changed <= PTHREADS_STORE_CHANGELOG_SIZE && pthreads_store_member_is_cacheable(destination, &key)) {
+								_pthreads_store_bump_modcount_nolock(PTHREADS_FETCH_FROM(destination), &key);
 							}
 
 							zval new_zstorage;
@@ -1210,8 +2623,8 @@ int pthreads_store_merge(zend_object *destination, zval *from, zend_bool overwri
 								}
 							}
 						}
-						if (overwrote_pthreads_object) {
-							_pthreads_store_bump_modcount_nolock(PTHREADS_FETCH_FROM(destination));
+						if (changed > PTHREADS_STORE_CHANGELOG_SIZE) {
+							_pthreads_store_bump_modcount_nolock(PTHREADS_FETCH_FROM(destination), NULL);
 						}
 						//TODO: sync local properties?
 
@@ -1237,6 +2650,10 @@ int pthreads_store_merge(zend_object *destination, zval *from, zend_bool overwri
 				int32_t index = 0;
 				HashTable *table = (Z_TYPE_P(from) == IS_ARRAY) ? Z_ARRVAL_P(from) : Z_OBJPROP_P(from);
 
+				if (Z_TYPE_P(from) == IS_ARRAY) {
+					pthreads_store_reserve_packed(&ts_obj->props, table);
+				}
+
 				for (zend_hash_internal_pointer_reset_ex(table, &position);
 					(pzval = zend_hash_get_current_data_ex(table, &position));
 					zend_hash_move_forward_ex(table, &position)) {
@@ -1275,20 +2692,50 @@ next:
 } /* }}} */
 
 
+/* {{{ */
+static size_t pthreads_store_storage_size(pthreads_store_type type) {
+	switch (type) {
+		case STORE_TYPE_CLOSURE: return sizeof(pthreads_closure_storage_t);
+		case STORE_TYPE_PTHREADS: return sizeof(pthreads_zend_object_storage_t);
+		case STORE_TYPE_RESOURCE: return sizeof(pthreads_resource_storage_t);
+#if HAVE_PTHREADS_EXT_SOCKETS_SUPPORT
+		case STORE_TYPE_SOCKET: return sizeof(pthreads_socket_storage_t);
+#endif
+		case STORE_TYPE_ENUM: return sizeof(pthreads_enum_storage_t);
+		case STORE_TYPE_STRING_PTR: return sizeof(pthreads_string_storage_t);
+		case STORE_TYPE_ARRAY: return sizeof(pthreads_array_storage_t);
+		case STORE_TYPE_SHARED_STRING: return sizeof(pthreads_shared_string_storage_t);
+		case STORE_TYPE_INLINE_STRING: return sizeof(pthreads_inline_string_storage_t);
+	}
+	ZEND_ASSERT(0);
+	return 0;
+} /* }}} */
+
 /* {{{ Will free store element */
 static void pthreads_store_storage_dtor (zval *zstorage){
 	if (!zstorage) return;
 
 	if (Z_TYPE_P(zstorage) == IS_PTR) {
 		pthreads_storage *storage = (pthreads_storage *) Z_PTR_P(zstorage);
+		if (pthreads_atomic_fetch_sub_u32(&storage->refcount, 1) != 1) {
+			//still referenced by a copy
+			return;
+		}
 		switch (storage->type) {
 			case STORE_TYPE_CLOSURE:
 			case STORE_TYPE_PTHREADS:
 			case STORE_TYPE_RESOURCE:
 			case STORE_TYPE_SOCKET:
 			case STORE_TYPE_STRING_PTR:
+			case STORE_TYPE_INLINE_STRING:
 				/* no extra action necessary */
 				break;
+			case STORE_TYPE_ARRAY:
+				pthreads_store_free_array(((pthreads_array_storage_t*)storage)->array);
+				break;
+			case STORE_TYPE_SHARED_STRING:
+				pefree(((pthreads_shared_string_storage_t*)storage)->string, 1);
+				break;
 #if PHP_VERSION_ID >= 80100
 			case STORE_TYPE_ENUM: {
 				pthreads_enum_storage_t* enum_storage = (pthreads_enum_storage_t*)storage;
@@ -1298,7 +2745,7 @@ static void pthreads_store_storage_dtor (zval *zstorage){
 #endif
 			default: break;
 		}
-		free(storage);
+		pthreads_slab_free(storage, pthreads_store_storage_size(storage->type));
 	} else if (Z_TYPE_P(zstorage) == IS_STRING) {
 		zend_string *str = Z_STR_P(zstorage);
 		zend_string_release_ex(str, 1);
@@ -1311,12 +2758,12 @@ static void pthreads_store_storage_dtor (zval *zstorage){
 void pthreads_store_reset(zend_object *object, HashPosition *position) {
 	pthreads_object_t *ts_obj = PTHREADS_FETCH_TS_FROM(object);
 
-	if (pthreads_monitor_lock(&ts_obj->monitor)) {
+	if (pthreads_monitor_lock_shared(&ts_obj->monitor)) {
 		zend_hash_internal_pointer_reset_ex(&ts_obj->props.hash, position);
 		if (zend_hash_has_more_elements_ex(&ts_obj->props.hash, position) == FAILURE) { //empty
 			*position = HT_INVALID_IDX;
 		}
-		pthreads_monitor_unlock(&ts_obj->monitor);
+		pthreads_monitor_unlock_shared(&ts_obj->monitor);
 	}
 }
 
@@ -1325,7 +2772,7 @@ void pthreads_store_key(zend_object *object, zval *key, HashPosition *position)
 	zend_string *str_key;
 	zend_ulong num_key;
 
-	if (pthreads_monitor_lock(&ts_obj->monitor)) {
+	if (pthreads_monitor_lock_shared(&ts_obj->monitor)) {
 		switch (zend_hash_get_current_key_ex(&ts_obj->props.hash, &str_key, &num_key, position)) {
 			case HASH_KEY_NON_EXISTENT:
 				ZVAL_NULL(key);
@@ -1337,37 +2784,50 @@ void pthreads_store_key(zend_object *object, zval *key, HashPosition *position)
 				ZVAL_STR(key, zend_string_dup(str_key, 0));
 			break;
 		}
-		pthreads_monitor_unlock(&ts_obj->monitor);
+		pthreads_monitor_unlock_shared(&ts_obj->monitor);
 	}
 }
 
 void pthreads_store_data(zend_object *object, zval *value, HashPosition *position) {
 	pthreads_object_t *ts_obj = PTHREADS_FETCH_TS_FROM(object);
+	zval key;
 
-	if (pthreads_monitor_lock(&ts_obj->monitor)) {
-		zval key;
-		zend_hash_get_current_key_zval_ex(&ts_obj->props.hash, &key, position);
+	if (pthreads_monitor_lock_shared(&ts_obj->monitor)) {
+		zend_string *str_key;
+		zend_ulong num_key;
 
-		if (pthreads_store_read(object, &key, BP_VAR_R, value) == FAILURE) {
-			ZVAL_UNDEF(value);
-		}
-		if (Z_TYPE(key) == IS_STRING) {
-			zend_string_release(Z_STR(key));
+		/* the key is copied rather than addref'd, since other readers may be holding the lock concurrently */
+		switch (zend_hash_get_current_key_ex(&ts_obj->props.hash, &str_key, &num_key, position)) {
+			case HASH_KEY_IS_LONG:
+				ZVAL_LONG(&key, num_key);
+			break;
+			case HASH_KEY_IS_STRING:
+				ZVAL_STR(&key, zend_string_dup(str_key, 0));
+			break;
+			default:
+				ZVAL_UNDEF(&key);
 		}
 
-		pthreads_monitor_unlock(&ts_obj->monitor);
+		pthreads_monitor_unlock_shared(&ts_obj->monitor);
+	} else ZVAL_UNDEF(&key);
+
+	if (Z_ISUNDEF(key) || pthreads_store_read(object, &key, BP_VAR_R, value) == FAILURE) {
+		ZVAL_UNDEF(value);
+	}
+	if (Z_TYPE(key) == IS_STRING) {
+		zend_string_release(Z_STR(key));
 	}
 }
 
 void pthreads_store_forward(zend_object *object, HashPosition *position) {
 	pthreads_object_t *ts_obj = PTHREADS_FETCH_TS_FROM(object);
 
-	if (pthreads_monitor_lock(&ts_obj->monitor)) {
+	if (pthreads_monitor_lock_shared(&ts_obj->monitor)) {
 		zend_hash_move_forward_ex(
 			&ts_obj->props.hash, position);
 		if (zend_hash_has_more_elements_ex(&ts_obj->props.hash, position) == FAILURE) {
 			*position = HT_INVALID_IDX;
 		}
-		pthreads_monitor_unlock(&ts_obj->monitor);
+		pthreads_monitor_unlock_shared(&ts_obj->monitor);
 	}
 } /* }}} */
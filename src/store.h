@@ -27,27 +27,100 @@
 #define PTHREADS_STORE_COERCE_ARRAY 1
 #define PTHREADS_STORE_NO_COERCE_ARRAY 0
 
+#define PTHREADS_STORE_NO_SLOT ((uint32_t) -1)
+
 #define TRY_PTHREADS_STORAGE_PTR_P(zval) ((zval) != NULL && Z_TYPE_P(zval) == IS_PTR ? (pthreads_storage *) Z_PTR_P(zval) : NULL)
 
+/* {{{ seqlock-protected copy of a scalar member, which can be read without acquiring the monitor
+	seq is odd while a write is in progress; value is IS_UNDEF when the member is not currently scalar */
+typedef struct _pthreads_store_scalar_cell_t {
+	volatile uint32_t seq;
+	zval value;
+} pthreads_store_scalar_cell_t; /* }}} */
+
+/* {{{ ring buffer of stored values, used by ThreadedQueue instead of the hash */
+typedef struct _pthreads_store_ring_t {
+	zval *items;
+	uint32_t size; //number of allocated items, always 0 or a power of 2
+	uint32_t head; //index of the first item
+	volatile uint32_t count; //may be read without holding the monitor
+	uint32_t waiters; //number of threads blocked in pthreads_store_ring_shift()
+	zend_long capacity; //maximum number of items, 0 if unbounded
+} pthreads_store_ring_t; /* }}} */
+
+/* {{{ entry in the log of members whose local caches were invalidated, indexed by modcount */
+#define PTHREADS_STORE_CHANGELOG_SIZE 32 //must be a power of 2
+
+typedef struct _pthreads_store_change_t {
+	zend_long modcount; //modcount after the change, -1 if the entry can't be used
+	zend_ulong idx;
+	zend_string *name; //persistent, NULL for integer keys
+} pthreads_store_change_t; /* }}} */
+
 typedef struct _pthreads_store_t {
 	HashTable hash;
+	volatile uint32_t count; //number of members in hash, which may be read without holding the monitor
 	zend_long modcount;
+	HashTable scalar_cells;
+	volatile uint32_t *slots; //bucket index in hash of each declared property, by property slot number - may be stale
+	uint32_t slots_count;
+	pthreads_store_ring_t *ring; //NULL unless the object is a ThreadedQueue
+	pthreads_store_change_t *changes; //allocated on the first change, PTHREADS_STORE_CHANGELOG_SIZE entries
+	uint32_t waiters; //number of threads blocked in pthreads_store_wait_until()
 } pthreads_store_t;
 
 void pthreads_store_init(pthreads_store_t* store);
+void pthreads_store_init_slots(pthreads_store_t* store, uint32_t count);
+void pthreads_store_init_ring(pthreads_store_t* store);
 void pthreads_store_destroy(pthreads_store_t* store);
 void pthreads_store_sync_local_properties(zend_object* object);
 void pthreads_store_full_sync_local_properties(zend_object *object);
+void pthreads_store_invalidate_local_properties(zend_object* object);
 int pthreads_store_merge(zend_object *destination, zval *from, zend_bool overwrite, zend_bool coerce_array_to_threaded);
 int pthreads_store_delete(zend_object *object, zval *key);
 int pthreads_store_read(zend_object *object, zval *key, int type, zval *read);
 zend_bool pthreads_store_isset(zend_object *object, zval *key, int has_set_exists);
 int pthreads_store_write(zend_object *object, zval *key, zval *write, zend_bool coerce_array_to_threaded);
+
+/* {{{ variants for declared properties, which can locate the member by its property slot number (OBJ_PROP_TO_NUM())
+	instead of hashing the name; slot may be PTHREADS_STORE_NO_SLOT */
+int pthreads_store_delete_ex(zend_object *object, zval *key, uint32_t slot);
+int pthreads_store_read_ex(zend_object *object, zval *key, uint32_t slot, int type, zval *read);
+zend_bool pthreads_store_isset_ex(zend_object *object, zval *key, uint32_t slot, int has_set_exists);
+int pthreads_store_write_ex(zend_object *object, zval *key, uint32_t slot, zval *write, zend_bool coerce_array_to_threaded); /* }}} */
+
+/* {{{ read-modify-write operations, performed under a single acquisition of the monitor
+	increment() type-checks the new value against info, if given, since it's only known under the lock; strict is the
+	caller's strict_types mode */
+int pthreads_store_increment(zend_object *object, zval *key, uint32_t slot, zend_property_info *info, zval *delta, zend_bool strict, zval *result);
+int pthreads_store_compare_and_set(zend_object *object, zval *key, uint32_t slot, zval *expected, zval *value);
+int pthreads_store_fetch_and_set(zend_object *object, zval *key, uint32_t slot, zval *value, zval *previous); /* }}} */
 void pthreads_store_tohash(zend_object *object, HashTable *hash);
 int pthreads_store_shift(zend_object *object, zval *member);
 int pthreads_store_chunk(zend_object *object, zend_long size, zend_bool preserve, zval *chunk);
 int pthreads_store_pop(zend_object *object, zval *member);
 int pthreads_store_count(zend_object *object, zend_long *count);
+
+/* {{{ ring buffer helpers for ThreadedQueue
+	shift() waits up to timeout microseconds for an item if the ring is empty, forever if timeout is 0, or not at all if
+	timeout is negative */
+int pthreads_store_ring_set_capacity(zend_object *object, zend_long capacity);
+int pthreads_store_ring_push(zend_object *object, zval *value);
+int pthreads_store_ring_shift(zend_object *object, zend_long timeout, zval *member);
+int pthreads_store_ring_pop(zend_object *object, zval *member);
+int pthreads_store_ring_count(zend_object *object, zend_long *count); /* }}} */
+/* {{{ conditions which pthreads_store_wait_until() can wait for without returning to user code */
+typedef enum _pthreads_store_condition_t {
+	PTHREADS_STORE_CONDITION_IDENTICAL, //the member is identical (===) to the expected value; undefined members are null
+	PTHREADS_STORE_CONDITION_NOT_EMPTY, //the member is set and not empty, as by !empty()
+	PTHREADS_STORE_CONDITION_COUNT, //the object has at least the expected (integer) number of members or items
+} pthreads_store_condition_t;
+
+/* {{{ Waits up to timeout nanoseconds, or forever if timeout is 0, until condition holds, evaluating it whenever the
+	members change; key and slot are unused for PTHREADS_STORE_CONDITION_COUNT, and may be NULL and PTHREADS_STORE_NO_SLOT
+	Returns SUCCESS if the condition holds, FAILURE if the timeout was reached first */
+int pthreads_store_wait_until(zend_object *object, pthreads_store_condition_t condition, zval *key, uint32_t slot, zval *expected, uint64_t timeout); /* }}} */
+
 /* {{{ Copies any thread-local data to permanent storage when an object ref is destroyed */
 void pthreads_store_persist_local_properties(zend_object* object); /* }}} */
 
@@ -57,4 +130,10 @@ void pthreads_store_key(zend_object *object, zval *key, HashPosition *position);
 void pthreads_store_data(zend_object *object, zval *value, HashPosition *position);
 void pthreads_store_forward(zend_object *object, HashPosition *position); /* }}} */
 
+/* {{{ Copies all members to snapshot while holding the lock once, for iteration without further locking */
+void pthreads_store_snapshot(zend_object *object, HashTable *snapshot); /* }}} */
+
+/* {{{ Copies all members to a plain array, converting nested ThreadedArrays to arrays when recursive */
+int pthreads_store_to_array(zend_object *object, zval *array, zend_bool recursive); /* }}} */
+
 #endif
@@ -29,10 +29,15 @@ typedef enum _pthreads_store_type {
 	STORE_TYPE_SOCKET,
 	STORE_TYPE_ENUM,
 	STORE_TYPE_STRING_PTR,
+	STORE_TYPE_ARRAY,
+	STORE_TYPE_SHARED_STRING,
+	STORE_TYPE_INLINE_STRING,
 } pthreads_store_type;
 
 typedef struct _pthreads_storage {
 	pthreads_store_type type;
+	volatile uint32_t refcount; //number of store entries referencing this storage, only modified atomically
+	uint64_t serial; //unique per storage, used to check if a locally cached value was restored from it
 } pthreads_storage;
 
 typedef struct _pthreads_closure_storage_t {
@@ -72,4 +77,23 @@ typedef struct _pthreads_string_storage_t {
 	zend_string* string;
 	pthreads_ident_t owner;
 } pthreads_string_storage_t;
+
+typedef struct _pthreads_shared_string_storage_t {
+	pthreads_storage common;
+	zend_string* string; //persistent, never exposed to user code; freed with the last copy of the storage
+} pthreads_shared_string_storage_t;
+
+/* {{{ short strings are copied into the storage itself, so that no thread owns them and they don't need persisting */
+#define PTHREADS_STORE_INLINE_STRING_MAX 32
+
+typedef struct _pthreads_inline_string_storage_t {
+	pthreads_storage common;
+	uint32_t length;
+	char value[PTHREADS_STORE_INLINE_STRING_MAX];
+} pthreads_inline_string_storage_t; /* }}} */
+
+typedef struct _pthreads_array_storage_t {
+	pthreads_storage common;
+	HashTable* array; //persistent deep copy, never modified after creation, so the storage may be shared by copies
+} pthreads_array_storage_t;
 #endif
@@ -40,6 +40,13 @@ typedef struct _pthreads_object_t {
 	pthreads_ident_t local;
 } pthreads_object_t; /* }}} */
 
+/* {{{ shared object of ThreadedAtomicInt and ThreadedAtomicFloat, allocated by pthreads_ts_object_ctor() for those
+	classes only, so that other objects don't pay for the value */
+typedef struct _pthreads_atomic_object_t {
+	pthreads_object_t common;
+	volatile uint64_t value; //only accessed with src/atomic.h
+} pthreads_atomic_object_t; /* }}} */
+
 /* {{{ */
 struct _pthreads_zend_object_t;
 typedef struct _pthreads_zend_object_t pthreads_zend_object_t;
@@ -49,6 +56,8 @@ struct _pthreads_zend_object_t {
 	pthreads_ident_t owner;
 	pthreads_zend_object_t *original_zobj; //NULL if this is the original object
 	zend_long local_props_modcount;
+	HashTable *local_scalar_cells; //scalar cells from ts_obj->props resolved by this thread, keyed by member name
+	HashTable *local_props_serials; //serial of the storage each value in std.properties was restored from, if needed to validate it
 	pthreads_worker_data_t *worker_data;
 	zend_object std;
 }; /* }}} */
@@ -83,6 +92,9 @@ static inline pthreads_zend_object_t* _pthreads_fetch_object(zend_object *object
 /* {{{ fetches the internal thread-safe object from $this */
 #define PTHREADS_FETCH_TS PTHREADS_FETCH_TS_FROM(Z_OBJ(EX(This))) /* }}} */
 
+/* {{{ fetches the value of the current ThreadedAtomicInt or ThreadedAtomicFloat from $this */
+#define PTHREADS_FETCH_ATOMIC (&((pthreads_atomic_object_t*) PTHREADS_FETCH_TS)->value) /* }}} */
+
 /* {{{ option constants */
 #define PTHREADS_INHERIT_NONE      0x00000000
 #define PTHREADS_INHERIT_INI       0x00000001
@@ -74,7 +74,7 @@ zend_long pthreads_worker_add_task(pthreads_worker_data_t *worker_data, zval *va
 		size = worker_data->queue.size;
 		pthreads_queue_push_new(&worker_data->queue, value);
 		if (!size) {
-			pthreads_monitor_notify(worker_data->monitor);
+			pthreads_monitor_notify_ex(worker_data->monitor, PTHREADS_MONITOR_QUEUE_STATE, NULL, 1);
 		}
 		size = worker_data->queue.size;
 		pthreads_monitor_unlock(worker_data->monitor);
@@ -179,7 +179,8 @@ pthreads_monitor_state_t pthreads_worker_next_task(pthreads_worker_data_t *worke
 					break;
 				}
 
-				pthreads_monitor_wait(worker_data->monitor, 0);
+				//state changes and new tasks are notified on the same queue
+				pthreads_monitor_wait_ex(worker_data->monitor, 0, PTHREADS_MONITOR_QUEUE_STATE, NULL);
 			} else {
 				//this is allocated on the creator thread's ZMM, so we can't free it
 				worker_data->running = worker_data->queue.head;
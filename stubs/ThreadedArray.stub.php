@@ -18,6 +18,15 @@ final class ThreadedArray extends ThreadedBase implements Countable, ArrayAccess
      */
     public function chunk(int $size, bool $preserve = false) : array{}
 
+    /**
+     * Creates a new ThreadedArray with the same members as this one
+     *
+     * The members aren't copied until they are written, so this is much cheaper than copying an array.
+     *
+     * @return ThreadedArray A new ThreadedArray object
+     */
+    public function copy() : ThreadedArray{}
+
     /**
      * {@inheritdoc}
      */
@@ -55,6 +64,18 @@ final class ThreadedArray extends ThreadedBase implements Countable, ArrayAccess
      */
     public function shift() : mixed{}
 
+    /**
+     * Copies the members of the array to a plain array
+     *
+     * Each ThreadedArray is locked once while its members are copied, which is much cheaper than reading members
+     * one at a time. An Error is thrown if a ThreadedArray contains itself and $recursive is true.
+     *
+     * @param bool $recursive Convert nested ThreadedArrays to arrays too
+     *
+     * @return array An array of the members of this ThreadedArray
+     */
+    public function toArray(bool $recursive = true) : array{}
+
 	public function offsetGet(mixed $offset) : mixed{}
 
 	public function offsetSet(mixed $offset, mixed $value) : void{}
@@ -0,0 +1,60 @@
+<?php
+
+/**
+ * ThreadedAtomicFloat objects hold a single floating point number which can be shared between threads.
+ *
+ * All operations are performed with atomic instructions rather than by acquiring the synchronization lock, which
+ * makes these objects well suited for counters and flags which are updated frequently by many threads.
+ *
+ * @generate-class-entries
+ * @strict-properties
+ */
+final class ThreadedAtomicFloat extends ThreadedBase
+{
+    /**
+     * @param float $value The initial value
+     */
+    public function __construct(float $value = 0.0){}
+
+    /**
+     * Gets the value
+     *
+     * @return float The current value
+     */
+    public function get() : float{}
+
+    /**
+     * Sets the value
+     *
+     * @param float $value The new value
+     */
+    public function set(float $value) : void{}
+
+    /**
+     * Adds delta to the value
+     *
+     * @param float $delta The amount to add
+     *
+     * @return float The new value
+     */
+    public function add(float $delta = 1.0) : float{}
+
+    /**
+     * Sets the value, returning the previous value
+     *
+     * @param float $value The new value
+     *
+     * @return float The previous value
+     */
+    public function swap(float $value) : float{}
+
+    /**
+     * Sets the value, only if the current value is equal to expected
+     *
+     * @param float $expected The value which must currently be held
+     * @param float $value The new value
+     *
+     * @return bool Whether the value was set
+     */
+    public function compareExchange(float $expected, float $value) : bool{}
+}
@@ -0,0 +1,56 @@
+/* This is a generated file, edit the .stub.php file instead.
+ * Stub hash: c4aba2edaf9581a124836d6d5c6e4a693ceedf38 */
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_class_ThreadedAtomicFloat___construct, 0, 0, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, value, IS_DOUBLE, 0, "0.0")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedAtomicFloat_get, 0, 0, IS_DOUBLE, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedAtomicFloat_set, 0, 1, IS_VOID, 0)
+	ZEND_ARG_TYPE_INFO(0, value, IS_DOUBLE, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedAtomicFloat_add, 0, 0, IS_DOUBLE, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, delta, IS_DOUBLE, 0, "1.0")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedAtomicFloat_swap, 0, 1, IS_DOUBLE, 0)
+	ZEND_ARG_TYPE_INFO(0, value, IS_DOUBLE, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedAtomicFloat_compareExchange, 0, 2, _IS_BOOL, 0)
+	ZEND_ARG_TYPE_INFO(0, expected, IS_DOUBLE, 0)
+	ZEND_ARG_TYPE_INFO(0, value, IS_DOUBLE, 0)
+ZEND_END_ARG_INFO()
+
+
+ZEND_METHOD(ThreadedAtomicFloat, __construct);
+ZEND_METHOD(ThreadedAtomicFloat, get);
+ZEND_METHOD(ThreadedAtomicFloat, set);
+ZEND_METHOD(ThreadedAtomicFloat, add);
+ZEND_METHOD(ThreadedAtomicFloat, swap);
+ZEND_METHOD(ThreadedAtomicFloat, compareExchange);
+
+
+static const zend_function_entry class_ThreadedAtomicFloat_methods[] = {
+	ZEND_ME(ThreadedAtomicFloat, __construct, arginfo_class_ThreadedAtomicFloat___construct, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedAtomicFloat, get, arginfo_class_ThreadedAtomicFloat_get, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedAtomicFloat, set, arginfo_class_ThreadedAtomicFloat_set, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedAtomicFloat, add, arginfo_class_ThreadedAtomicFloat_add, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedAtomicFloat, swap, arginfo_class_ThreadedAtomicFloat_swap, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedAtomicFloat, compareExchange, arginfo_class_ThreadedAtomicFloat_compareExchange, ZEND_ACC_PUBLIC)
+	ZEND_FE_END
+};
+
+static zend_class_entry *register_class_ThreadedAtomicFloat(zend_class_entry *class_entry_ThreadedBase)
+{
+	zend_class_entry ce, *class_entry;
+
+	INIT_CLASS_ENTRY(ce, "ThreadedAtomicFloat", class_ThreadedAtomicFloat_methods);
+	class_entry = zend_register_internal_class_ex(&ce, class_entry_ThreadedBase);
+	class_entry->ce_flags |= ZEND_ACC_FINAL|ZEND_ACC_NO_DYNAMIC_PROPERTIES;
+
+	return class_entry;
+}
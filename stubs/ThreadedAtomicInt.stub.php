@@ -0,0 +1,62 @@
+<?php
+
+/**
+ * ThreadedAtomicInt objects hold a single integer which can be shared between threads.
+ *
+ * All operations are performed with atomic instructions rather than by acquiring the synchronization lock, which
+ * makes these objects well suited for counters and flags which are updated frequently by many threads.
+ *
+ * Unlike regular integers, the value wraps around on overflow instead of becoming a float.
+ *
+ * @generate-class-entries
+ * @strict-properties
+ */
+final class ThreadedAtomicInt extends ThreadedBase
+{
+    /**
+     * @param int $value The initial value
+     */
+    public function __construct(int $value = 0){}
+
+    /**
+     * Gets the value
+     *
+     * @return int The current value
+     */
+    public function get() : int{}
+
+    /**
+     * Sets the value
+     *
+     * @param int $value The new value
+     */
+    public function set(int $value) : void{}
+
+    /**
+     * Adds delta to the value
+     *
+     * @param int $delta The amount to add
+     *
+     * @return int The new value
+     */
+    public function add(int $delta = 1) : int{}
+
+    /**
+     * Sets the value, returning the previous value
+     *
+     * @param int $value The new value
+     *
+     * @return int The previous value
+     */
+    public function swap(int $value) : int{}
+
+    /**
+     * Sets the value, only if the current value is equal to expected
+     *
+     * @param int $expected The value which must currently be held
+     * @param int $value The new value
+     *
+     * @return bool Whether the value was set
+     */
+    public function compareExchange(int $expected, int $value) : bool{}
+}
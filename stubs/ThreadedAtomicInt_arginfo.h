@@ -0,0 +1,56 @@
+/* This is a generated file, edit the .stub.php file instead.
+ * Stub hash: 42c4bd8094ec1e958547d7fe275e4745bb6fc693 */
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_class_ThreadedAtomicInt___construct, 0, 0, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, value, IS_LONG, 0, "0")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedAtomicInt_get, 0, 0, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedAtomicInt_set, 0, 1, IS_VOID, 0)
+	ZEND_ARG_TYPE_INFO(0, value, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedAtomicInt_add, 0, 0, IS_LONG, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, delta, IS_LONG, 0, "1")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedAtomicInt_swap, 0, 1, IS_LONG, 0)
+	ZEND_ARG_TYPE_INFO(0, value, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedAtomicInt_compareExchange, 0, 2, _IS_BOOL, 0)
+	ZEND_ARG_TYPE_INFO(0, expected, IS_LONG, 0)
+	ZEND_ARG_TYPE_INFO(0, value, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+
+ZEND_METHOD(ThreadedAtomicInt, __construct);
+ZEND_METHOD(ThreadedAtomicInt, get);
+ZEND_METHOD(ThreadedAtomicInt, set);
+ZEND_METHOD(ThreadedAtomicInt, add);
+ZEND_METHOD(ThreadedAtomicInt, swap);
+ZEND_METHOD(ThreadedAtomicInt, compareExchange);
+
+
+static const zend_function_entry class_ThreadedAtomicInt_methods[] = {
+	ZEND_ME(ThreadedAtomicInt, __construct, arginfo_class_ThreadedAtomicInt___construct, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedAtomicInt, get, arginfo_class_ThreadedAtomicInt_get, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedAtomicInt, set, arginfo_class_ThreadedAtomicInt_set, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedAtomicInt, add, arginfo_class_ThreadedAtomicInt_add, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedAtomicInt, swap, arginfo_class_ThreadedAtomicInt_swap, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedAtomicInt, compareExchange, arginfo_class_ThreadedAtomicInt_compareExchange, ZEND_ACC_PUBLIC)
+	ZEND_FE_END
+};
+
+static zend_class_entry *register_class_ThreadedAtomicInt(zend_class_entry *class_entry_ThreadedBase)
+{
+	zend_class_entry ce, *class_entry;
+
+	INIT_CLASS_ENTRY(ce, "ThreadedAtomicInt", class_ThreadedAtomicInt_methods);
+	class_entry = zend_register_internal_class_ex(&ce, class_entry_ThreadedBase);
+	class_entry->ce_flags |= ZEND_ACC_FINAL|ZEND_ACC_NO_DYNAMIC_PROPERTIES;
+
+	return class_entry;
+}
@@ -18,17 +18,24 @@ class ThreadedBase implements IteratorAggregate
     /**
      * Send notification to the referenced object
      *
+     * Only contexts which are waiting for the same key, or without a key if none is given, are woken.
+     *
+     * @param string|null $key The condition to notify waiters of
+     *
      * @link http://www.php.net/manual/en/threaded.notify.php
      * @return bool A boolean indication of success
      */
-    public function notify() : bool{}
+    public function notify(?string $key = null) : bool{}
 
     /**
-     * Send notification to one context waiting on the Threaded
+     * Send notification to the context which has waited longest on the Threaded for the same key, or without a key if
+     * none is given
+     *
+     * @param string|null $key The condition to notify a waiter of
      *
      * @return bool A boolean indication of success
      */
-    public function notifyOne() : bool{}
+    public function notifyOne(?string $key = null) : bool{}
 
     /**
      * Executes the block while retaining the synchronization lock for the current context.
@@ -44,12 +51,120 @@ class ThreadedBase implements IteratorAggregate
     /**
      * Waits for notification from the Stackable
      *
+     * The synchronization lock must be held while waiting. If a key is given, only notifications for the same key
+     * will end the wait, so that unrelated notifications don't wake this context.
+     *
      * @param int $timeout An optional timeout in microseconds
+     * @param string|null $key The condition to wait for notification of
      *
      * @link http://www.php.net/manual/en/threaded.wait.php
-     * @return bool A boolean indication of success
+     * @return bool false if the timeout was reached or the lock isn't held, true if notified
+     */
+    public function wait(int $timeout = 0, ?string $key = null) : bool{}
+
+    /**
+     * Waits for notification from the referenced object, with a timeout in nanoseconds
+     *
+     * The timeout is measured by a monotonic clock where the platform allows it, so changes to the system time don't
+     * make the wait end early or late.
+     *
+     * @param int $nanoseconds An optional timeout in nanoseconds; 0 waits until notified
+     * @param string|null $key The condition to wait for notification of
+     *
+     * @return bool false if the timeout was reached or the lock isn't held, true if notified
+     */
+    public function waitNs(int $nanoseconds = 0, ?string $key = null) : bool{}
+
+    /**
+     * Reads several members while retaining the synchronization lock, so that the values are consistent with each other
+     *
+     * @param array $keys The names of the members to read
+     *
+     * @return array The values of the members, keyed by name
+     */
+    public function getMany(array $keys) : array{}
+
+    /**
+     * Writes several members while retaining the synchronization lock, so that other contexts see either none or all of the changes
+     *
+     * @param array $values The values to write, keyed by member name
+     */
+    public function setMany(array $values) : void{}
+
+    /**
+     * Adds delta to a numeric member while retaining the synchronization lock, as ++ would; undefined and null members
+     * count as 0, numeric strings are converted, and uninitialized typed properties throw
+     *
+     * @param string|int $key The name of the member
+     * @param int|float $delta The amount to add
+     *
+     * @return int|float|string|bool The new value of the member, which may be coerced to the type of the property
      */
-    public function wait(int $timeout = 0) : bool{}
+    public function increment(string|int $key, int|float $delta = 1) : int|float|string|bool{}
 
-	public function getIterator() : Iterator{}
+    /**
+     * Sets a member to value, only if its current value is identical to expected, while retaining the synchronization lock
+     *
+     * @param string|int $key The name of the member
+     * @param mixed $expected The value the member must currently have; undefined members have the value null
+     * @param mixed $value The new value
+     *
+     * @return bool Whether the member was set
+     */
+    public function compareAndSet(string|int $key, mixed $expected, mixed $value) : bool{}
+
+    /**
+     * Sets a member to value while retaining the synchronization lock
+     *
+     * @param string|int $key The name of the member
+     * @param mixed $value The new value
+     *
+     * @return mixed The previous value of the member
+     */
+    public function fetchAndSet(string|int $key, mixed $value) : mixed{}
+
+    /**
+     * Waits until a member is identical (===) to expected. The condition is checked natively whenever the members of
+     * this object change, so the calling context only resumes once it holds or the timeout is reached.
+     *
+     * @param string|int $key The name of the member
+     * @param mixed $expected The value to wait for; undefined members have the value null
+     * @param int $nanoseconds An optional timeout in nanoseconds; 0 waits until the condition holds
+     *
+     * @return bool Whether the member is identical to expected
+     */
+    public function waitUntil(string|int $key, mixed $expected, int $nanoseconds = 0) : bool{}
+
+    /**
+     * Waits until a member is set and not empty, as by !empty()
+     *
+     * @param string|int $key The name of the member
+     * @param int $nanoseconds An optional timeout in nanoseconds; 0 waits until the condition holds
+     *
+     * @return bool Whether the member is set and not empty
+     */
+    public function waitUntilNotEmpty(string|int $key, int $nanoseconds = 0) : bool{}
+
+    /**
+     * Waits until this object has at least the given number of members, or items for a ThreadedQueue
+     *
+     * @param int $count The number of members to wait for
+     * @param int $nanoseconds An optional timeout in nanoseconds; 0 waits until the condition holds
+     *
+     * @return bool Whether this object has at least count members
+     */
+    public function waitUntilCount(int $count, int $nanoseconds = 0) : bool{}
+
+    /**
+     * Returns an iterator over the members of this object
+     *
+     * By default, each step of the iteration reads the current state of the object. If snapshot is true, all members
+     * are copied at once while retaining the synchronization lock, and the iteration doesn't observe later changes.
+     * This is much faster for large objects.
+     *
+     * @param bool $snapshot Whether to iterate over a copy of the members taken now
+     *
+     * @return Iterator
+     */
+    public function getIterator(bool $snapshot = false) : Iterator{}
 }
@@ -1,7 +1,8 @@
 /* This is a generated file, edit the .stub.php file instead.
- * Stub hash: 0592dabf61bfcf1e3073647ba80e3b352afe5d6b */
+ * Stub hash: 6faef04eceffbed195b61de55625acb2dd8558b9 */
 
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedBase_notify, 0, 0, _IS_BOOL, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, key, IS_STRING, 1, "null")
 ZEND_END_ARG_INFO()
 
 #define arginfo_class_ThreadedBase_notifyOne arginfo_class_ThreadedBase_notify
@@ -13,9 +14,56 @@ ZEND_END_ARG_INFO()
 
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedBase_wait, 0, 0, _IS_BOOL, 0)
 	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 0, "0")
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, key, IS_STRING, 1, "null")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedBase_waitNs, 0, 0, _IS_BOOL, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, nanoseconds, IS_LONG, 0, "0")
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, key, IS_STRING, 1, "null")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedBase_getMany, 0, 1, IS_ARRAY, 0)
+	ZEND_ARG_TYPE_INFO(0, keys, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedBase_setMany, 0, 1, IS_VOID, 0)
+	ZEND_ARG_TYPE_INFO(0, values, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_MASK_EX(arginfo_class_ThreadedBase_increment, 0, 1, MAY_BE_LONG|MAY_BE_DOUBLE|MAY_BE_STRING|MAY_BE_BOOL)
+	ZEND_ARG_TYPE_MASK(0, key, MAY_BE_STRING|MAY_BE_LONG, NULL)
+	ZEND_ARG_TYPE_MASK(0, delta, MAY_BE_LONG|MAY_BE_DOUBLE, "1")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedBase_compareAndSet, 0, 3, _IS_BOOL, 0)
+	ZEND_ARG_TYPE_MASK(0, key, MAY_BE_STRING|MAY_BE_LONG, NULL)
+	ZEND_ARG_TYPE_INFO(0, expected, IS_MIXED, 0)
+	ZEND_ARG_TYPE_INFO(0, value, IS_MIXED, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedBase_fetchAndSet, 0, 2, IS_MIXED, 0)
+	ZEND_ARG_TYPE_MASK(0, key, MAY_BE_STRING|MAY_BE_LONG, NULL)
+	ZEND_ARG_TYPE_INFO(0, value, IS_MIXED, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedBase_waitUntil, 0, 2, _IS_BOOL, 0)
+	ZEND_ARG_TYPE_MASK(0, key, MAY_BE_STRING|MAY_BE_LONG, NULL)
+	ZEND_ARG_TYPE_INFO(0, expected, IS_MIXED, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, nanoseconds, IS_LONG, 0, "0")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedBase_waitUntilNotEmpty, 0, 1, _IS_BOOL, 0)
+	ZEND_ARG_TYPE_MASK(0, key, MAY_BE_STRING|MAY_BE_LONG, NULL)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, nanoseconds, IS_LONG, 0, "0")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedBase_waitUntilCount, 0, 1, _IS_BOOL, 0)
+	ZEND_ARG_TYPE_INFO(0, count, IS_LONG, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, nanoseconds, IS_LONG, 0, "0")
 ZEND_END_ARG_INFO()
 
 ZEND_BEGIN_ARG_WITH_RETURN_OBJ_INFO_EX(arginfo_class_ThreadedBase_getIterator, 0, 0, Iterator, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, snapshot, _IS_BOOL, 0, "false")
 ZEND_END_ARG_INFO()
 
 
@@ -23,6 +71,15 @@ ZEND_METHOD(ThreadedBase, notify);
 ZEND_METHOD(ThreadedBase, notifyOne);
 ZEND_METHOD(ThreadedBase, synchronized);
 ZEND_METHOD(ThreadedBase, wait);
+ZEND_METHOD(ThreadedBase, waitNs);
+ZEND_METHOD(ThreadedBase, getMany);
+ZEND_METHOD(ThreadedBase, setMany);
+ZEND_METHOD(ThreadedBase, increment);
+ZEND_METHOD(ThreadedBase, compareAndSet);
+ZEND_METHOD(ThreadedBase, fetchAndSet);
+ZEND_METHOD(ThreadedBase, waitUntil);
+ZEND_METHOD(ThreadedBase, waitUntilNotEmpty);
+ZEND_METHOD(ThreadedBase, waitUntilCount);
 ZEND_METHOD(ThreadedBase, getIterator);
 
 
@@ -31,6 +88,15 @@ static const zend_function_entry class_ThreadedBase_methods[] = {
 	ZEND_ME(ThreadedBase, notifyOne, arginfo_class_ThreadedBase_notifyOne, ZEND_ACC_PUBLIC)
 	ZEND_ME(ThreadedBase, synchronized, arginfo_class_ThreadedBase_synchronized, ZEND_ACC_PUBLIC)
 	ZEND_ME(ThreadedBase, wait, arginfo_class_ThreadedBase_wait, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedBase, waitNs, arginfo_class_ThreadedBase_waitNs, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedBase, getMany, arginfo_class_ThreadedBase_getMany, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedBase, setMany, arginfo_class_ThreadedBase_setMany, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedBase, increment, arginfo_class_ThreadedBase_increment, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedBase, compareAndSet, arginfo_class_ThreadedBase_compareAndSet, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedBase, fetchAndSet, arginfo_class_ThreadedBase_fetchAndSet, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedBase, waitUntil, arginfo_class_ThreadedBase_waitUntil, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedBase, waitUntilNotEmpty, arginfo_class_ThreadedBase_waitUntilNotEmpty, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedBase, waitUntilCount, arginfo_class_ThreadedBase_waitUntilCount, ZEND_ACC_PUBLIC)
 	ZEND_ME(ThreadedBase, getIterator, arginfo_class_ThreadedBase_getIterator, ZEND_ACC_PUBLIC)
 	ZEND_FE_END
 };
@@ -0,0 +1,49 @@
+<?php
+
+/**
+ * ThreadedQueue objects are first-in-first-out queues which can be shared between threads.
+ *
+ * Items are kept in a ring buffer, so pushing and shifting take constant time regardless of how many items have
+ * passed through the queue.
+ *
+ * @generate-class-entries
+ * @strict-properties
+ */
+final class ThreadedQueue extends ThreadedBase implements Countable
+{
+    /**
+     * @param int $capacity The maximum number of items in the queue, or 0 for no limit
+     */
+    public function __construct(int $capacity = 0){}
+
+    /**
+     * Adds an item to the end of the queue
+     *
+     * @param mixed $value The item to add
+     *
+     * @return bool false if the queue is full
+     */
+    public function push(mixed $value) : bool{}
+
+    /**
+     * Removes the first item from the queue
+     *
+     * @param int|null $timeout If not null, the number of microseconds to wait for an item if the queue is empty,
+     * or 0 to wait until one is available
+     *
+     * @return mixed The first item in the queue, or null if there was none
+     */
+    public function shift(?int $timeout = null) : mixed{}
+
+    /**
+     * Removes the last item from the queue
+     *
+     * @return mixed The last item in the queue, or null if there was none
+     */
+    public function pop() : mixed{}
+
+    /**
+     * {@inheritdoc}
+     */
+    public function count() : int{}
+}
@@ -0,0 +1,49 @@
+/* This is a generated file, edit the .stub.php file instead.
+ * Stub hash: 77391378adb4cc4ece62978111229c6f551fe107 */
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_class_ThreadedQueue___construct, 0, 0, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, capacity, IS_LONG, 0, "0")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedQueue_push, 0, 1, _IS_BOOL, 0)
+	ZEND_ARG_TYPE_INFO(0, value, IS_MIXED, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedQueue_shift, 0, 0, IS_MIXED, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 1, "null")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedQueue_pop, 0, 0, IS_MIXED, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_ThreadedQueue_count, 0, 0, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+
+ZEND_METHOD(ThreadedQueue, __construct);
+ZEND_METHOD(ThreadedQueue, push);
+ZEND_METHOD(ThreadedQueue, shift);
+ZEND_METHOD(ThreadedQueue, pop);
+ZEND_METHOD(ThreadedQueue, count);
+
+
+static const zend_function_entry class_ThreadedQueue_methods[] = {
+	ZEND_ME(ThreadedQueue, __construct, arginfo_class_ThreadedQueue___construct, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedQueue, push, arginfo_class_ThreadedQueue_push, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedQueue, shift, arginfo_class_ThreadedQueue_shift, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedQueue, pop, arginfo_class_ThreadedQueue_pop, ZEND_ACC_PUBLIC)
+	ZEND_ME(ThreadedQueue, count, arginfo_class_ThreadedQueue_count, ZEND_ACC_PUBLIC)
+	ZEND_FE_END
+};
+
+static zend_class_entry *register_class_ThreadedQueue(zend_class_entry *class_entry_ThreadedBase, zend_class_entry *class_entry_Countable)
+{
+	zend_class_entry ce, *class_entry;
+
+	INIT_CLASS_ENTRY(ce, "ThreadedQueue", class_ThreadedQueue_methods);
+	class_entry = zend_register_internal_class_ex(&ce, class_entry_ThreadedBase);
+	class_entry->ce_flags |= ZEND_ACC_FINAL|ZEND_ACC_NO_DYNAMIC_PROPERTIES;
+	zend_class_implements(class_entry, 1, class_entry_Countable);
+
+	return class_entry;
+}
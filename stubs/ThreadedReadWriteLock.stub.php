@@ -0,0 +1,13 @@
+<?php
+
+/**
+ * Attribute which opts a ThreadedBase class into reader/writer locking.
+ *
+ * Objects of classes marked with this attribute allow any number of threads to read, isset(), count() and iterate their
+ * members concurrently. Writes and synchronized() blocks remain exclusive, and wait()/notify() behave as usual.
+ *
+ * @generate-class-entries
+ */
+final class ThreadedReadWriteLock
+{
+}
@@ -0,0 +1,20 @@
+/* This is a generated file, edit the .stub.php file instead.
+ * Stub hash: efffd97332c98b6610faaa3e8f3fa46abef3583d */
+
+
+
+
+static const zend_function_entry class_ThreadedReadWriteLock_methods[] = {
+	ZEND_FE_END
+};
+
+static zend_class_entry *register_class_ThreadedReadWriteLock(void)
+{
+	zend_class_entry ce, *class_entry;
+
+	INIT_CLASS_ENTRY(ce, "ThreadedReadWriteLock", class_ThreadedReadWriteLock_methods);
+	class_entry = zend_register_internal_class_ex(&ce, NULL);
+	class_entry->ce_flags |= ZEND_ACC_FINAL;
+
+	return class_entry;
+}
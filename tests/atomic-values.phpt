@@ -0,0 +1,57 @@
+--TEST--
+Test ThreadedAtomicInt and ThreadedAtomicFloat
+--DESCRIPTION--
+This test verifies that concurrent updates of atomic values from several threads are never lost,
+and the semantics of each operation.
+--FILE--
+<?php
+class T extends Thread {
+	public function __construct(
+		private ThreadedAtomicInt $int,
+		private ThreadedAtomicFloat $float
+	) {}
+
+	public function run() : void {
+		for ($i = 0; $i < 10000; $i++) {
+			$this->int->add();
+			$this->float->add(0.5);
+		}
+	}
+}
+
+$int = new ThreadedAtomicInt;
+$float = new ThreadedAtomicFloat(1.0);
+$threads = [];
+for ($i = 0; $i < 4; $i++) {
+	$threads[$i] = new T($int, $float);
+	$threads[$i]->start();
+}
+foreach ($threads as $thread) {
+	$thread->join();
+}
+var_dump($int->get(), $float->get());
+
+var_dump($int->add(-40000), $int->swap(5), $int->get());
+var_dump($int->compareExchange(4, 6), $int->compareExchange(5, 6), $int->get());
+$int->set(PHP_INT_MAX);
+var_dump($int->add() === PHP_INT_MIN);
+
+var_dump($float->swap(-0.0), $float->compareExchange(0.0, 1.5), $float->get());
+$float->set(NAN);
+var_dump($float->compareExchange(NAN, 1.0), is_nan($float->get()));
+?>
+--EXPECT--
+int(40000)
+float(20001)
+int(0)
+int(0)
+int(5)
+bool(false)
+bool(true)
+int(6)
+bool(true)
+float(20001)
+bool(true)
+float(1.5)
+bool(false)
+bool(true)
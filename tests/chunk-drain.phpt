@@ -0,0 +1,43 @@
+--TEST--
+Check draining with chunk
+--DESCRIPTION--
+This test verifies that draining a ThreadedArray used as a queue with ::chunk returns members in order,
+while other members are appended in between and the table is compacted
+--FILE--
+<?php
+$s = new ThreadedArray();
+$s->merge(array_fill(0, 5000, true));
+$s["name"] = "value";
+
+$next = 0;
+$ordered = true;
+$drained = 0;
+while (count($chunk = $s->chunk(1000)) > 0) {
+	foreach ($chunk as $key => $value) {
+		if ($key === "name") {
+			continue;
+		}
+		if ($key !== $next++) {
+			$ordered = false;
+		}
+		$drained++;
+	}
+	if ($next < 8000) {
+		for ($i = 0; $i < 500; $i++) {
+			$s[] = true;
+		}
+	}
+}
+var_dump($ordered, $drained, count($s));
+
+$s[] = true;
+var_dump($s->chunk(10));
+?>
+--EXPECT--
+bool(true)
+int(9000)
+int(0)
+array(1) {
+  [9000]=>
+  bool(true)
+}
@@ -0,0 +1,71 @@
+--TEST--
+Test declared property access after unset and re-assignment
+--DESCRIPTION--
+Declared properties are located by their slot in the thread-safe store rather than by name where possible.
+This test verifies that they are still resolved correctly when private properties shadow each other, and
+when properties are unset and re-assigned in a different order.
+--FILE--
+<?php
+class A extends ThreadedBase {
+	private $value = "A";
+	public int $typed;
+
+	public function getA() { return $this->value; }
+}
+
+class B extends A {
+	private $value = "B";
+	public $other = 1;
+
+	public function getB() { return $this->value; }
+}
+
+$b = new B;
+var_dump($b->getA(), $b->getB());
+
+unset($b->other);
+var_dump(isset($b->other));
+$b->dynamic = "dynamic";
+$b->typed = 2;
+$b->other = 3;
+var_dump($b->other, $b->typed, $b->dynamic);
+
+class T extends Thread {
+	public $b;
+
+	public function __construct(B $b) {
+		$this->b = $b;
+	}
+
+	public function run() : void {
+		var_dump($this->b->getA(), $this->b->getB(), $this->b->other, $this->b->typed);
+		unset($this->b->typed);
+		$this->b->other = 4;
+	}
+}
+
+$thread = new T($b);
+$thread->start();
+$thread->join();
+
+var_dump(isset($b->typed), $b->other);
+try {
+	var_dump($b->typed);
+} catch (Error $e) {
+	echo $e->getMessage() . PHP_EOL;
+}
+?>
+--EXPECT--
+string(1) "A"
+string(1) "B"
+bool(false)
+int(3)
+int(2)
+string(7) "dynamic"
+string(1) "A"
+string(1) "B"
+int(3)
+int(2)
+bool(false)
+int(4)
+Typed property A::$typed must not be accessed before initialization
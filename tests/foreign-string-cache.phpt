@@ -0,0 +1,71 @@
+--TEST--
+Test local caching of strings written by other threads
+--DESCRIPTION--
+Strings read from members written by another thread are cached by the reading thread until the member is rewritten.
+This test verifies that rewritten members are always seen, whether they are replaced by another string, by an
+interned string, or by a scalar.
+--FILE--
+<?php
+class Config extends ThreadedBase {
+	public $name;
+	public $version = 0;
+}
+
+class T extends Thread {
+	public $config;
+
+	public function __construct(Config $config) {
+		$this->config = $config;
+	}
+
+	public function run() : void {
+		for ($i = 0; $i < 3; $i++) {
+			var_dump($this->config->name);
+		}
+		$this->config->synchronized(function() {
+			$this->config->version = 1;
+			$this->config->notify();
+			while ($this->config->version === 1) {
+				$this->config->wait();
+			}
+		});
+		var_dump($this->config->name);
+
+		$this->config->name = str_repeat("b", 3);
+		var_dump($this->config->name);
+		$this->config->name = 1;
+		var_dump($this->config->name);
+	}
+}
+
+$config = new Config;
+$config->name = str_repeat("a", 3);
+
+$thread = new T($config);
+$thread->start();
+$config->synchronized(function() use ($config) {
+	while ($config->version === 0) {
+		$config->wait();
+	}
+	$config->name = "interned";
+	$config->version = 2;
+	$config->notify();
+});
+$thread->join();
+
+var_dump($config->name);
+$config->name = "interned";
+var_dump($config->name);
+$config->name = str_repeat("c", 3);
+var_dump($config->name);
+?>
+--EXPECT--
+string(3) "aaa"
+string(3) "aaa"
+string(3) "aaa"
+string(8) "interned"
+string(3) "bbb"
+int(1)
+int(1)
+string(8) "interned"
+string(3) "ccc"
@@ -0,0 +1,80 @@
+--TEST--
+Test batch reads and writes of members
+--DESCRIPTION--
+getMany() and setMany() read and write several members while retaining the synchronization lock.
+This test verifies that other threads never observe a partially applied setMany(), and that the usual
+visibility and type rules are enforced.
+--FILE--
+<?php
+class Point extends ThreadedBase {
+	public $x = 0;
+	public $y = 0;
+	public int $typed = 0;
+	private $hidden = "hidden";
+}
+
+class T extends Thread {
+	public $point;
+	public $consistent = true;
+
+	public function __construct(Point $point) {
+		$this->point = $point;
+	}
+
+	public function run() : void {
+		do {
+			$values = $this->point->getMany(["x", "y"]);
+			if ($values["x"] !== $values["y"]) {
+				$this->consistent = false;
+			}
+		} while ($values["x"] < 1000);
+	}
+}
+
+$point = new Point;
+$thread = new T($point);
+$thread->start();
+for ($i = 1; $i <= 1000; $i++) {
+	$point->setMany(["x" => $i, "y" => $i]);
+}
+$thread->join();
+var_dump($thread->consistent);
+
+$point->setMany(["dynamic" => "value", 5 => "five"]);
+var_dump($point->getMany(["x", "dynamic", 5]));
+
+try {
+	$point->setMany(["typed" => "not an int"]);
+} catch (TypeError $e) {
+	echo $e->getMessage() . PHP_EOL;
+}
+try {
+	$point->getMany(["hidden"]);
+} catch (Error $e) {
+	echo $e->getMessage() . PHP_EOL;
+}
+
+$array = new ThreadedArray;
+$array->setMany(["a", "b", "key" => "c"]);
+var_dump($array->getMany([0, 1, "key"]));
+?>
+--EXPECT--
+bool(true)
+array(3) {
+  ["x"]=>
+  int(1000)
+  ["dynamic"]=>
+  string(5) "value"
+  [5]=>
+  string(4) "five"
+}
+Cannot assign string to property Point::$typed of type int
+Cannot access private property Point::$hidden
+array(3) {
+  [0]=>
+  string(1) "a"
+  [1]=>
+  string(1) "b"
+  ["key"]=>
+  string(1) "c"
+}
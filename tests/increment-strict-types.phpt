@@ -0,0 +1,45 @@
+--TEST--
+Test increment() in strict and weak mode
+--DESCRIPTION--
+increment() checks the new value against the type of the property in the caller's strict_types mode, as ++ would.
+This test verifies that a float result isn't coerced to an int property in strict mode, and that a result coerced to
+a string property in weak mode is stored and read back like any other string.
+--FILE--
+<?php
+declare(strict_types=1);
+
+require_once sprintf("%s/increment-weak-types.inc", __DIR__);
+
+class Counter extends ThreadedBase {
+	public int $count = 1;
+	public string $label = "10";
+}
+
+$counter = new Counter;
+var_dump($counter->increment("count"));
+try {
+	$counter->increment("count", 1.0);
+} catch (TypeError $e) {
+	echo $e->getMessage() . PHP_EOL;
+}
+var_dump($counter->count);
+
+var_dump(incrementWeak($counter, "label"));
+
+$thread = new class($counter) extends Thread {
+	public function __construct(private Counter $counter) {}
+
+	public function run() : void {
+		var_dump(incrementWeak($this->counter, "label"));
+	}
+};
+$thread->start() && $thread->join();
+var_dump($counter->label);
+?>
+--EXPECT--
+int(2)
+Cannot assign float to property Counter::$count of type int
+int(2)
+string(2) "11"
+string(2) "12"
+string(2) "12"
@@ -0,0 +1,88 @@
+--TEST--
+Test incremental sync of the local property cache
+--DESCRIPTION--
+Threads only revalidate the cached members changed since their last sync, unless more members changed than
+the change log can remember, in which case the whole cache is revalidated.
+This test verifies that rewritten members are always seen in both cases, and that unchanged members are kept.
+--FILE--
+<?php
+class Registry extends ThreadedBase {
+	public $step = 0;
+}
+
+class T extends Thread {
+	public function __construct(private Registry $registry) {}
+
+	private function waitFor(int $step) : void {
+		$this->registry->synchronized(function() use ($step) {
+			while ($this->registry->step !== $step) {
+				$this->registry->wait();
+			}
+		});
+	}
+
+	private function dump() : void {
+		$values = [];
+		for ($i = 0; $i < 40; $i++) {
+			$values[] = $this->registry->{"m$i"}["v"];
+		}
+		echo implode(",", $values) . PHP_EOL;
+	}
+
+	public function run() : void {
+		$this->dump();
+		$this->registry->synchronized(function() {
+			$this->registry->step = 1;
+			$this->registry->notify();
+		});
+		$this->waitFor(2);
+		$this->dump();
+		$this->registry->synchronized(function() {
+			$this->registry->step = 3;
+			$this->registry->notify();
+		});
+		$this->waitFor(4);
+		$this->dump();
+	}
+}
+
+$registry = new Registry;
+for ($i = 0; $i < 40; $i++) {
+	$registry->{"m$i"} = ["v" => 0];
+}
+
+$thread = new T($registry);
+$thread->start();
+
+$advance = function(int $from, int $to, callable $update) use ($registry) {
+	$registry->synchronized(function() use ($registry, $from, $to, $update) {
+		while ($registry->step !== $from) {
+			$registry->wait();
+		}
+		$update();
+		$registry->step = $to;
+		$registry->notify();
+	});
+};
+
+//a few changes are covered by the change log
+$advance(1, 2, function() use ($registry) {
+	$registry->m3 = ["v" => 1];
+	$registry->m17 = ["v" => 1];
+	unset($registry->m39);
+	$registry->m39 = ["v" => 1];
+});
+
+//too many changes for the change log
+$advance(3, 4, function() use ($registry) {
+	for ($i = 0; $i < 40; $i += 2) {
+		$registry->{"m$i"} = ["v" => 2];
+		$registry->{"m$i"} = ["v" => 3];
+	}
+});
+$thread->join();
+?>
+--EXPECT--
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1
+3,0,3,1,3,0,3,0,3,0,3,0,3,0,3,0,3,1,3,0,3,0,3,0,3,0,3,0,3,0,3,0,3,0,3,0,3,0,3,1
@@ -0,0 +1,45 @@
+--TEST--
+Test short strings stored by value
+--DESCRIPTION--
+Strings of up to 32 bytes are copied into the store, instead of referencing the writing thread's string.
+This test verifies that such strings survive the thread which wrote them, and behave like any other string.
+--FILE--
+<?php
+$shared = new ThreadedArray;
+
+$thread = new class($shared) extends Thread {
+	public function __construct(private ThreadedArray $shared) {}
+
+	public function run() : void {
+		$this->shared["short"] = str_repeat("a", 5);
+		$this->shared["limit"] = str_repeat("b", 32);
+		$this->shared["long"] = str_repeat("c", 33);
+		$this->shared["empty"] = substr("x", 1);
+		$this->shared["zero"] = (string) 0;
+		$this->shared["binary"] = "a\0b" . chr(255);
+		var_dump($this->shared["short"]);
+	}
+};
+$thread->start();
+$thread->join();
+
+var_dump($shared["short"], strlen($shared["limit"]), strlen($shared["long"]));
+var_dump($shared["empty"], isset($shared["empty"]), empty($shared["empty"]), empty($shared["zero"]));
+var_dump(bin2hex($shared["binary"]));
+
+$copy = $shared->copy();
+$shared["short"] = "changed";
+var_dump($copy["short"], $shared["short"]);
+?>
+--EXPECT--
+string(5) "aaaaa"
+string(5) "aaaaa"
+int(32)
+int(33)
+string(0) ""
+bool(true)
+bool(true)
+bool(true)
+string(8) "610062ff"
+string(5) "aaaaa"
+string(7) "changed"
@@ -0,0 +1,51 @@
+--TEST--
+Test iterating over a snapshot of members
+--DESCRIPTION--
+getIterator(true) copies all members while holding the lock once, and iterates over the copy.
+This test verifies that the snapshot doesn't observe later changes, and that Threaded members keep their identity.
+--FILE--
+<?php
+$array = new ThreadedArray;
+$array["a"] = 1;
+$array[5] = "five";
+$array["child"] = new ThreadedArray;
+$array[] = [1, 2];
+
+$thread = new class($array) extends Thread {
+	public function __construct(private ThreadedArray $array) {}
+
+	public function run() : void {
+		$child = $this->array["child"];
+		$iterator = $this->array->getIterator(true);
+		$this->array["late"] = true;
+		unset($this->array["a"]);
+
+		foreach ($iterator as $key => $value) {
+			var_dump($key, $value === $child ? "same child" : $value);
+		}
+		var_dump(iterator_count($this->array->getIterator(true)));
+	}
+};
+$thread->start();
+$thread->join();
+
+var_dump($array->getIterator(true) instanceof Iterator);
+var_dump(iterator_to_array($array->getIterator(true)) === iterator_to_array($array));
+?>
+--EXPECT--
+string(1) "a"
+int(1)
+int(5)
+string(4) "five"
+string(5) "child"
+string(10) "same child"
+int(6)
+array(2) {
+  [0]=>
+  int(1)
+  [1]=>
+  int(2)
+}
+int(4)
+bool(true)
+bool(true)
@@ -0,0 +1,81 @@
+--TEST--
+Test waiting for keyed notifications
+--DESCRIPTION--
+wait() and waitNs() may be given a key, in which case only notifications for the same key end the wait. This test
+verifies that a keyed waiter isn't woken by notifications for other keys or without a key, and that notifyOne()
+wakes exactly one waiter for its key.
+--FILE--
+<?php
+$shared = new ThreadedArray;
+$shared["stage"] = "none";
+
+$thread = new class($shared) extends Thread {
+	public function __construct(private ThreadedArray $shared) {}
+
+	public function run() : void {
+		foreach (["b" => "b", "plain" => null, "a" => "a"] as $stage => $key) {
+			$this->shared->synchronized(function() use ($stage, $key) : void {
+				$this->shared["stage"] = $stage;
+				$this->shared->notify($key);
+			});
+		}
+	}
+};
+
+var_dump($shared->synchronized(function() use ($shared, $thread) : array {
+	$thread->start();
+	$wakeups = 0;
+	while ($shared["stage"] !== "a") {
+		if ($shared->wait(10 * 1000000, "a")) {
+			$wakeups++;
+		}
+	}
+	return [$wakeups, $shared["stage"]];
+}));
+$thread->join();
+
+$shared["waiting"] = 0;
+$shared["results"] = new ThreadedArray;
+
+$waiters = [];
+for ($i = 0; $i < 2; $i++) {
+	$waiters[$i] = new class($shared) extends Thread {
+		public function __construct(private ThreadedArray $shared) {}
+
+		public function run() : void {
+			$this->shared->synchronized(function() : void {
+				$this->shared["waiting"]++;
+				$this->shared->notify("ready");
+				$this->shared["results"][] = $this->shared->waitNs(500000000, "x");
+			});
+		}
+	};
+	$waiters[$i]->start();
+}
+
+$shared->synchronized(function() use ($shared) : void {
+	while ($shared["waiting"] < 2) {
+		$shared->wait(0, "ready");
+	}
+	$shared->notifyOne("x");
+});
+foreach ($waiters as $waiter) {
+	$waiter->join();
+}
+$results = $shared["results"]->toArray();
+sort($results);
+var_dump($results);
+?>
+--EXPECT--
+array(2) {
+  [0]=>
+  int(1)
+  [1]=>
+  string(1) "a"
+}
+array(2) {
+  [0]=>
+  bool(false)
+  [1]=>
+  bool(true)
+}
@@ -0,0 +1,69 @@
+--TEST--
+Test count() and isset() answered without locking
+--DESCRIPTION--
+count() reads a count published by writers, and isset() is answered from this thread's scalar cells or local
+cache when possible. This test verifies that both still observe changes made by other threads.
+--FILE--
+<?php
+class Flags extends ThreadedBase {
+	public $done = false;
+	public $value = 1;
+}
+
+$array = new ThreadedArray;
+$flags = new Flags;
+$queue = new ThreadedQueue;
+
+var_dump(count($array), isset($array[0]), isset($array["missing"]));
+$array[0] = new ThreadedArray;
+$array["string"] = str_repeat("s", 3);
+var_dump(count($array), isset($array[0]), isset($array["string"]), $array[0] instanceof ThreadedArray);
+var_dump($flags->value, isset($flags->value), empty($flags->done));
+
+$thread = new class($array, $flags, $queue) extends Thread {
+	public function __construct(
+		private ThreadedArray $array,
+		private Flags $flags,
+		private ThreadedQueue $queue
+	) {}
+
+	public function run() : void {
+		for ($i = 0; $i < 100; $i++) {
+			$this->queue->push($i);
+		}
+		unset($this->array[0]);
+		$this->array["string"] = null;
+		$this->array[] = 1;
+		$this->flags->value = null;
+		$this->flags->done = true;
+	}
+};
+$thread->start();
+
+//polling doesn't take the monitor, but must still see every change
+while (!$flags->done);
+while (count($queue) < 100);
+var_dump(count($queue));
+
+$thread->join();
+var_dump(count($array), isset($array[0]), isset($array["string"]), array_key_exists("string", (array) $array));
+var_dump(isset($flags->value), empty($flags->done));
+?>
+--EXPECT--
+int(0)
+bool(false)
+bool(false)
+int(2)
+bool(true)
+bool(true)
+bool(true)
+int(1)
+bool(true)
+bool(true)
+int(100)
+int(2)
+bool(false)
+bool(false)
+bool(true)
+bool(false)
+bool(false)
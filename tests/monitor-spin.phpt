@@ -0,0 +1,47 @@
+--TEST--
+Test contended monitor acquisition
+--DESCRIPTION--
+Contended monitors are retried up to pthreads.monitor_spin times before the acquiring thread blocks.
+This test verifies that heavily contended monitors still exclude each other, and that the contention counters shown
+by phpinfo() add up.
+--INI--
+pthreads.monitor_spin=50
+--FILE--
+<?php
+var_dump(ini_get("pthreads.monitor_spin"));
+
+$shared = new ThreadedArray;
+$shared["counter"] = 0;
+
+$threads = [];
+for ($t = 0; $t < 4; $t++) {
+	$threads[$t] = new class($shared) extends Thread {
+		public function __construct(private ThreadedArray $shared) {}
+
+		public function run() : void {
+			for ($i = 0; $i < 5000; $i++) {
+				$this->shared->synchronized(function() : void {
+					$this->shared["counter"]++;
+				});
+			}
+		}
+	};
+	$threads[$t]->start();
+}
+foreach ($threads as $thread) {
+	$thread->join();
+}
+var_dump($shared["counter"]);
+
+ob_start();
+phpinfo(INFO_MODULES);
+$info = ob_get_clean();
+preg_match('/Contended acquisitions => (\d+)/', $info, $contended);
+preg_match('/Acquired by spinning => (\d+)/', $info, $spun);
+preg_match('/Blocked => (\d+)/', $info, $blocked);
+var_dump((int) $contended[1] === $spun[1] + $blocked[1]);
+?>
+--EXPECT--
+string(2) "50"
+int(20000)
+bool(true)
@@ -0,0 +1,73 @@
+--TEST--
+Test property access through the runtime cache
+--DESCRIPTION--
+Property handlers cache property lookups in the runtime cache of each opline.
+This test verifies that the same call site can be used with both thread-safe and regular objects, that
+visibility errors are raised on every access, and that writes from other threads are still seen.
+--FILE--
+<?php
+class Plain {
+	public $value = "plain";
+}
+
+class Shared extends ThreadedBase {
+	public $value = "shared";
+	private $hidden = "hidden";
+}
+
+function read($object) {
+	return $object->value;
+}
+
+function write($object, $value) {
+	$object->value = $value;
+}
+
+$plain = new Plain;
+$shared = new Shared;
+for ($i = 0; $i < 3; $i++) {
+	var_dump(read($plain), read($shared));
+}
+
+write($plain, "plain2");
+write($shared, "shared2");
+var_dump($plain->value, $shared->value);
+
+for ($i = 0; $i < 2; $i++) {
+	try {
+		var_dump($shared->hidden);
+	} catch (Error $e) {
+		echo $e->getMessage() . PHP_EOL;
+	}
+}
+
+$thread = new class($shared) extends Thread {
+	public $shared;
+
+	public function __construct(Shared $shared) {
+		$this->shared = $shared;
+	}
+
+	public function run() : void {
+		for ($i = 0; $i < 3; $i++) {
+			$this->shared->value = "thread" . $i;
+		}
+	}
+};
+$thread->start();
+$thread->join();
+
+var_dump(read($shared));
+?>
+--EXPECT--
+string(5) "plain"
+string(6) "shared"
+string(5) "plain"
+string(6) "shared"
+string(5) "plain"
+string(6) "shared"
+string(6) "plain2"
+string(7) "shared2"
+Cannot access private property Shared::$hidden
+Cannot access private property Shared::$hidden
+string(7) "thread2"
@@ -0,0 +1,112 @@
+--TEST--
+Test atomic read-modify-write operations on members
+--DESCRIPTION--
+increment(), compareAndSet() and fetchAndSet() read and write a member under a single acquisition of the monitor.
+This test verifies that concurrent increments are never lost, and the semantics of each operation, which follow those
+of the equivalent PHP operators.
+--FILE--
+<?php
+class Stats extends ThreadedBase {
+	public $hits = 0;
+	public int $typed = 0;
+	public int $count = 1;
+	public int $uninitialized;
+	private $hidden = 0;
+}
+
+class T extends Thread {
+	public $stats;
+
+	public function __construct(Stats $stats) {
+		$this->stats = $stats;
+	}
+
+	public function run() : void {
+		for ($i = 0; $i < 10000; $i++) {
+			$this->stats->increment("hits");
+		}
+	}
+}
+
+$stats = new Stats;
+$threads = [];
+for ($i = 0; $i < 4; $i++) {
+	$threads[$i] = new T($stats);
+	$threads[$i]->start();
+}
+foreach ($threads as $thread) {
+	$thread->join();
+}
+var_dump($stats->hits);
+
+var_dump($stats->increment("hits", 0.5));
+var_dump($stats->increment("undefined", 2));
+var_dump($stats->increment("typed", PHP_INT_MAX));
+try {
+	$stats->increment("typed");
+} catch (TypeError $e) {
+	echo $e->getMessage() . PHP_EOL;
+}
+var_dump($stats->typed);
+
+//like ++, numeric strings are converted, and the result is coerced to the property type outside of strict mode
+$stats->numeric = " 41";
+$stats->fraction = "1.5";
+var_dump($stats->increment("numeric"), $stats->increment("fraction"), $stats->increment("count", 1.0));
+try {
+	$stats->increment("uninitialized");
+} catch (Error $e) {
+	echo $e->getMessage() . PHP_EOL;
+}
+
+$stats->name = "name";
+try {
+	$stats->increment("name");
+} catch (TypeError $e) {
+	echo $e->getMessage() . PHP_EOL;
+}
+try {
+	$stats->increment("hidden");
+} catch (Error $e) {
+	echo $e->getMessage() . PHP_EOL;
+}
+
+var_dump($stats->compareAndSet("name", "other", "new"), $stats->name);
+var_dump($stats->compareAndSet("name", "name", "new"), $stats->name);
+var_dump($stats->compareAndSet("missing", null, 1), $stats->missing);
+var_dump($stats->compareAndSet("typed", PHP_INT_MAX, 1), $stats->typed);
+
+var_dump($stats->fetchAndSet("name", new ThreadedArray), $stats->name instanceof ThreadedArray);
+var_dump($stats->fetchAndSet("unset", 1));
+
+$array = new ThreadedArray;
+var_dump($array->increment(0), $array->increment("0", 2), $array->fetchAndSet(0, "a"), $array[0]);
+?>
+--EXPECT--
+int(40000)
+float(40000.5)
+int(2)
+int(9223372036854775807)
+Cannot assign float to property Stats::$typed of type int
+int(9223372036854775807)
+int(42)
+float(2.5)
+int(2)
+Typed property Stats::$uninitialized must not be accessed before initialization
+Cannot increment non-numeric member of Stats
+Cannot access private property Stats::$hidden
+bool(false)
+string(4) "name"
+bool(true)
+string(3) "new"
+bool(true)
+int(1)
+bool(true)
+int(1)
+string(3) "new"
+bool(true)
+NULL
+int(1)
+int(3)
+int(3)
+string(1) "a"
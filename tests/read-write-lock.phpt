@@ -0,0 +1,84 @@
+--TEST--
+Test reader/writer locking mode
+--DESCRIPTION--
+This test verifies that objects of classes marked with #[ThreadedReadWriteLock] can be read concurrently
+by several threads while another thread writes to them, and that synchronized(), wait() and notify()
+continue to work as usual.
+--FILE--
+<?php
+#[ThreadedReadWriteLock]
+class Registry extends ThreadedBase {
+	public $version = 0;
+	public $ready = false;
+}
+
+class Reader extends Thread {
+	public $registry;
+	public $seen = 0;
+
+	public function __construct(Registry $registry) {
+		$this->registry = $registry;
+	}
+
+	public function run() : void {
+		$seen = 0;
+		while ($this->registry->version < 1000) {
+			$version = $this->registry->version;
+			if ($version < $seen) {
+				throw new \Error("version went backwards");
+			}
+			$seen = $version;
+			isset($this->registry->ready);
+			foreach ($this->registry as $key => $value) {}
+		}
+		$this->seen = $this->registry->version;
+	}
+}
+
+class Waiter extends Thread {
+	public $registry;
+
+	public function __construct(Registry $registry) {
+		$this->registry = $registry;
+	}
+
+	public function run() : void {
+		$this->registry->synchronized(function() {
+			while (!$this->registry->ready) {
+				$this->registry->wait();
+			}
+		});
+	}
+}
+
+$registry = new Registry;
+$threads = [new Waiter($registry)];
+for ($i = 0; $i < 3; $i++) {
+	$threads[] = new Reader($registry);
+}
+foreach ($threads as $thread) {
+	$thread->start();
+}
+
+for ($i = 1; $i <= 1000; $i++) {
+	$registry->version = $i;
+}
+
+$registry->synchronized(function() use ($registry) {
+	$registry->ready = true;
+	$registry->notify();
+});
+
+foreach ($threads as $thread) {
+	$thread->join();
+}
+for ($i = 1; $i < count($threads); $i++) {
+	var_dump($threads[$i]->seen);
+}
+var_dump($registry->ready);
+?>
+--EXPECT--
+int(1000)
+int(1000)
+int(1000)
+bool(true)
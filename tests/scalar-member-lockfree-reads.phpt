@@ -0,0 +1,76 @@
+--TEST--
+Test lock-free reads of scalar members
+--DESCRIPTION--
+Scalar members which have been read once are subsequently read without acquiring the monitor.
+This test verifies that such reads always observe writes made by other threads, including
+changes of type, unsetting, and changing to a non-scalar value.
+--FILE--
+<?php
+class Counter extends ThreadedBase {
+	public $count = 0;
+	public $done = false;
+	public $value;
+}
+
+class T extends Thread {
+	public $counter;
+
+	public function __construct(Counter $counter) {
+		$this->counter = $counter;
+	}
+
+	public function run() : void {
+		for ($i = 0; $i < 10000; $i++) {
+			$this->counter->synchronized(function() {
+				$this->counter->count++;
+			});
+		}
+		$this->counter->done = true;
+	}
+}
+
+$counter = new Counter;
+$threads = [];
+for ($i = 0; $i < 4; $i++) {
+	$threads[$i] = new T($counter);
+	$threads[$i]->start();
+}
+
+$last = 0;
+$monotonic = true;
+while ($counter->count < 40000) {
+	$count = $counter->count;
+	if ($count < $last) {
+		$monotonic = false;
+	}
+	$last = $count;
+}
+
+foreach ($threads as $thread) {
+	$thread->join();
+}
+var_dump($monotonic, $counter->count, $counter->done);
+
+$counter->value = 1;
+var_dump($counter->value);
+$counter->value = 1.5;
+var_dump($counter->value);
+$counter->value = "string";
+var_dump($counter->value);
+$counter->value = new ThreadedArray();
+var_dump($counter->value instanceof ThreadedArray);
+unset($counter->value);
+var_dump(isset($counter->value));
+$counter->value = null;
+var_dump($counter->value);
+?>
+--EXPECT--
+bool(true)
+int(40000)
+bool(true)
+int(1)
+float(1.5)
+string(6) "string"
+bool(true)
+bool(false)
+NULL
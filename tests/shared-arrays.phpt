@@ -0,0 +1,77 @@
+--TEST--
+Test arrays as members of thread-safe objects
+--DESCRIPTION--
+Arrays containing only scalars, strings and other such arrays are stored as immutable copies, which every thread
+can read without the array being converted to a ThreadedArray.
+--FILE--
+<?php
+class Config extends ThreadedBase {
+	public $table;
+	public $empty = [];
+}
+
+class T extends Thread {
+	public $config;
+
+	public function __construct(Config $config) {
+		$this->config = $config;
+	}
+
+	public function run() : void {
+		$table = $this->config->table;
+		var_dump(is_array($table), count($table["lookup"]), $table["lookup"][9999], $table["nested"]["key"]);
+
+		//local modifications must not be visible to anyone else
+		$table["lookup"][0] = "changed";
+		var_dump($this->config->table["lookup"][0]);
+
+		$this->config->table = ["replaced" => true];
+	}
+}
+
+$config = new Config;
+$config->table = [
+	"lookup" => array_map(fn($i) => "value$i", range(0, 9999)),
+	"nested" => ["key" => str_repeat("x", 3), 1 => 1.5, 2 => null],
+];
+var_dump(isset($config->table), empty($config->empty), $config->empty);
+
+$thread = new T($config);
+$thread->start();
+$thread->join();
+
+var_dump($config->table);
+
+try {
+	$config->table["foo"] = "bar";
+} catch (Error $e) {
+	echo $e->getMessage() . PHP_EOL;
+}
+
+$threaded = new ThreadedArray;
+$threaded[] = [1, 2, 3];
+var_dump($threaded[0]);
+?>
+--EXPECT--
+bool(true)
+bool(true)
+array(0) {
+}
+bool(true)
+int(10000)
+string(9) "value9999"
+string(3) "xxx"
+string(6) "value0"
+array(1) {
+  ["replaced"]=>
+  bool(true)
+}
+Indirect modification of non-Threaded members of Config is not supported
+array(3) {
+  [0]=>
+  int(1)
+  [1]=>
+  int(2)
+  [2]=>
+  int(3)
+}
@@ -0,0 +1,54 @@
+--TEST--
+Test strings shared between thread-safe objects
+--DESCRIPTION--
+Strings which are copied between thread-safe objects (e.g. by merge()), or which outlive the thread that
+created them, are stored once and shared between all the objects referencing them.
+--FILE--
+<?php
+class T extends Thread {
+	public $source;
+
+	public function __construct(ThreadedArray $source) {
+		$this->source = $source;
+	}
+
+	public function run() : void {
+		//these strings are owned by this thread, which will be gone by the time they're read
+		$this->source["payload"] = str_repeat("a", 100000);
+		$this->source["zero"] = str_repeat("0", 1);
+	}
+}
+
+$source = new ThreadedArray;
+$thread = new T($source);
+$thread->start();
+$thread->join();
+unset($thread);
+
+$copies = [];
+for ($i = 0; $i < 3; $i++) {
+	$copy = new ThreadedArray;
+	$copy->merge($source);
+	$copies[] = $copy;
+}
+unset($source);
+
+foreach ($copies as $copy) {
+	var_dump(strlen($copy["payload"]), $copy["payload"] === str_repeat("a", 100000), empty($copy["zero"]));
+}
+
+$copies[0]["payload"] = "changed";
+var_dump($copies[0]["payload"], strlen($copies[1]["payload"]));
+?>
+--EXPECT--
+int(100000)
+bool(true)
+bool(true)
+int(100000)
+bool(true)
+bool(true)
+int(100000)
+bool(true)
+bool(true)
+string(7) "changed"
+int(100000)
@@ -0,0 +1,49 @@
+--TEST--
+Test recycling of storage allocations across threads
+--DESCRIPTION--
+Storage for non-scalar members is allocated from slabs and recycled through per-thread caches.
+This test verifies that storage allocated by one thread and freed by another is recycled safely, and that the
+counters shown by phpinfo() reflect it.
+--FILE--
+<?php
+$shared = new ThreadedArray;
+
+$threads = [];
+for ($t = 0; $t < 4; $t++) {
+	$threads[$t] = new class($shared, $t) extends Thread {
+		public function __construct(private ThreadedArray $shared, private int $id) {}
+
+		public function run() : void {
+			for ($i = 0; $i < 5000; $i++) {
+				//overwriting another thread's member frees storage allocated by that thread
+				$this->shared[$i % 16] = str_repeat((string) $this->id, 8);
+				$this->shared[16 + ($i % 16)] = [$this->id, $i];
+			}
+		}
+	};
+	$threads[$t]->start();
+}
+foreach ($threads as $thread) {
+	$thread->join();
+}
+
+$valid = true;
+for ($i = 0; $i < 16; $i++) {
+	if (!preg_match('/^([0-3])\1{7}$/', $shared[$i]) || count($shared[16 + $i]) !== 2) {
+		$valid = false;
+	}
+}
+var_dump(count($shared), $valid);
+
+ob_start();
+phpinfo(INFO_MODULES);
+$info = ob_get_clean();
+preg_match('/Storage allocations => Count\s+Total => (\d+)/', $info, $total);
+preg_match('/Avoided malloc\(\) => (\d+)/', $info, $avoided);
+var_dump($total[1] >= 40000, $avoided[1] > $total[1] / 2);
+?>
+--EXPECT--
+int(32)
+bool(true)
+bool(true)
+bool(true)
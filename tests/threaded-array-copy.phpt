@@ -0,0 +1,67 @@
+--TEST--
+Test copying and merging ThreadedArrays
+--DESCRIPTION--
+copy() and merge() between ThreadedArrays share the stored members instead of copying them.
+This test verifies that writes to either side are not seen by the other, and that shared members outlive the
+object they were copied from.
+--FILE--
+<?php
+$source = new ThreadedArray;
+$source["string"] = str_repeat("s", 3);
+$source["array"] = [1, [2, 3]];
+$source["child"] = new ThreadedArray;
+$source["int"] = 1;
+
+$copy = $source->copy();
+var_dump($copy["string"], $copy["array"], $copy["child"] === $source["child"], $copy["int"]);
+
+$copy["string"] = "changed";
+unset($source["array"]);
+$source["int"] = 2;
+var_dump($source["string"], $copy["string"], isset($source["array"]), $copy["array"][1][1], $copy["int"]);
+
+$accumulator = new ThreadedArray;
+$thread = new class($accumulator) extends Thread {
+	public function __construct(private ThreadedArray $accumulator) {}
+
+	public function run() : void {
+		for ($tick = 0; $tick < 3; $tick++) {
+			$batch = new ThreadedArray;
+			for ($i = 0; $i < 3; $i++) {
+				$batch["$tick.$i"] = [$tick, str_repeat("x", $i)];
+			}
+			$this->accumulator->merge($batch);
+		}
+	}
+};
+$thread->start();
+$thread->join();
+var_dump(count($accumulator), $accumulator["2.2"]);
+?>
+--EXPECT--
+string(3) "sss"
+array(2) {
+  [0]=>
+  int(1)
+  [1]=>
+  array(2) {
+    [0]=>
+    int(2)
+    [1]=>
+    int(3)
+  }
+}
+bool(true)
+int(1)
+string(3) "sss"
+string(7) "changed"
+bool(false)
+int(3)
+int(1)
+int(9)
+array(2) {
+  [0]=>
+  int(2)
+  [1]=>
+  string(2) "xx"
+}
@@ -0,0 +1,65 @@
+--TEST--
+Test list-like ThreadedArrays
+--DESCRIPTION--
+ThreadedArrays with sequential integer keys are stored packed until a key is added out of order.
+This test verifies that reads, appends and ordering are unaffected by the conversion to a hash.
+--FILE--
+<?php
+$list = ThreadedArray::fromArray(range(0, 99));
+var_dump(count($list), $list[0], $list[99], isset($list[100]));
+
+$list[] = 100;
+$list[200] = 200;
+$list[] = 201;
+$list["key"] = "value";
+$list[50] = "fifty";
+unset($list[1]);
+var_dump(count($list), $list[100], $list[200], $list[201], $list[50], isset($list[1]));
+
+$keys = [];
+foreach ($list as $key => $value) {
+	$keys[] = $key;
+}
+echo implode(",", array_slice($keys, 0, 3)) . "..." . implode(",", array_slice($keys, -4)) . PHP_EOL;
+
+$copy = new ThreadedArray;
+$copy->merge($list);
+var_dump($copy->getMany([0, 50, 200, "key"]));
+
+$thread = new class($list) extends Thread {
+	public function __construct(private ThreadedArray $list) {}
+
+	public function run() : void {
+		$sum = 0;
+		for ($i = 2; $i < 50; $i++) {
+			$sum += $this->list[$i];
+		}
+		var_dump($sum);
+	}
+};
+$thread->start();
+$thread->join();
+?>
+--EXPECT--
+int(100)
+int(0)
+int(99)
+bool(false)
+int(103)
+int(100)
+int(200)
+int(201)
+string(5) "fifty"
+bool(false)
+0,2,3...100,200,201,key
+array(4) {
+  [0]=>
+  int(0)
+  [50]=>
+  string(5) "fifty"
+  [200]=>
+  int(200)
+  ["key"]=>
+  string(5) "value"
+}
+int(1224)
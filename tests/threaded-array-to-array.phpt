@@ -0,0 +1,46 @@
+--TEST--
+Test converting ThreadedArrays to arrays
+--DESCRIPTION--
+toArray() copies all members while locking each ThreadedArray once, converting nested ThreadedArrays unless
+told not to. This test verifies the result, including members written by other threads, and that a
+ThreadedArray containing itself is rejected.
+--FILE--
+<?php
+$shared = ThreadedArray::fromArray([
+	"name" => "root",
+	"list" => [1, 2, [3]],
+	"plain" => [4, 5]
+]);
+
+$thread = new class($shared) extends Thread {
+	public function __construct(private ThreadedArray $shared) {}
+
+	public function run() : void {
+		$this->shared["child"] = new ThreadedArray;
+		$this->shared["child"]["value"] = str_repeat("v", 40);
+		$this->shared["alias"] = $this->shared["child"];
+	}
+};
+$thread->start();
+$thread->join();
+
+echo json_encode($shared->toArray()) . PHP_EOL;
+
+$shallow = $shared->toArray(false);
+var_dump($shallow["list"] instanceof ThreadedArray, $shallow["child"] === $shared["child"], is_string($shallow["name"]));
+
+$shared["child"]["self"] = $shared;
+try {
+	$shared->toArray();
+} catch (Error $e) {
+	echo $e->getMessage() . PHP_EOL;
+}
+var_dump(count($shared->toArray(false)));
+?>
+--EXPECT--
+{"name":"root","list":[1,2,[3]],"plain":[4,5],"child":{"value":"vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv"},"alias":{"value":"vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv"}}
+bool(true)
+bool(true)
+bool(true)
+Cannot convert ThreadedArray containing itself to array
+int(5)
@@ -0,0 +1,71 @@
+--TEST--
+Test ThreadedQueue
+--DESCRIPTION--
+This test verifies FIFO ordering across ring buffer growth and wrap-around, bounded capacity,
+and blocking shift() with and without a timeout.
+--FILE--
+<?php
+$queue = new ThreadedQueue;
+for ($i = 0; $i < 6; $i++) {
+	$queue->push($i);
+}
+var_dump($queue->shift(), $queue->shift(), $queue->pop());
+for ($i = 6; $i < 20; $i++) {
+	$queue->push(str_repeat("x", $i));
+}
+var_dump(count($queue));
+$items = [];
+while (($item = $queue->shift()) !== null) {
+	$items[] = is_string($item) ? strlen($item) : $item;
+}
+echo implode(",", $items) . PHP_EOL;
+var_dump($queue->pop(), $queue->shift(1000));
+
+$bounded = new ThreadedQueue(2);
+var_dump($bounded->push(1), $bounded->push(new ThreadedArray), $bounded->push(3));
+var_dump($bounded->shift(), $bounded->shift() instanceof ThreadedArray, $bounded->push(3));
+
+try {
+	$queue->push(new stdClass);
+} catch (Error $e) {
+	echo $e->getMessage() . PHP_EOL;
+}
+
+$thread = new class($queue) extends Thread {
+	public function __construct(private ThreadedQueue $queue) {}
+
+	public function run() : void {
+		for ($i = 0; $i < 1000; $i++) {
+			$this->queue->push("item" . $i);
+		}
+		$this->queue->push(null);
+	}
+};
+$thread->start();
+$count = 0;
+$ordered = true;
+while (($item = $queue->shift(0)) !== null) {
+	if ($item !== "item" . $count++) {
+		$ordered = false;
+	}
+}
+$thread->join();
+var_dump($count, $ordered);
+?>
+--EXPECT--
+int(0)
+int(1)
+int(5)
+int(17)
+2,3,4,6,7,8,9,10,11,12,13,14,15,16,17,18,19
+NULL
+NULL
+bool(true)
+bool(true)
+bool(false)
+int(1)
+bool(true)
+bool(true)
+Unsupported data type object
+int(1000)
+bool(true)
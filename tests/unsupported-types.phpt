@@ -4,10 +4,12 @@ Test that unsupported types are correctly rejected
 <?php
 
 $threaded = new ThreadedArray;
+$recursive = [1];
+$recursive[] = &$recursive;
 foreach([
-	[],
-	[1, 2, 3],
-	array_fill(0, 10, 0),
+	[new \stdClass],
+	[1, [2, [fopen("php://memory", "r")]]],
+	$recursive,
 	new \stdClass,
 ] as $bannedType){
 	try{
@@ -16,10 +18,11 @@ foreach([
 		echo $e->getMessage() . PHP_EOL;
 	}
 }
+var_dump(count($threaded));
 ?>
 --EXPECT--
 Cannot assign non-thread-safe value of type array to ThreadedArray
 Cannot assign non-thread-safe value of type array to ThreadedArray
 Cannot assign non-thread-safe value of type array to ThreadedArray
 Cannot assign non-thread-safe value of type object to ThreadedArray
-
+int(0)
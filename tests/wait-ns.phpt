@@ -0,0 +1,58 @@
+--TEST--
+Test waiting with a timeout in nanoseconds
+--DESCRIPTION--
+waitNs() waits with a nanosecond timeout measured on a monotonic clock, and returns false only if the timeout was
+reached. This test verifies that timeouts and notifications can be told apart.
+--FILE--
+<?php
+$shared = new ThreadedArray;
+$shared["ready"] = false;
+
+$result = $shared->synchronized(function() use ($shared) : array {
+	$start = hrtime(true);
+	$result = $shared->waitNs(2000000);
+	return [$result, hrtime(true) - $start >= 2000000];
+});
+var_dump($result);
+
+var_dump($shared->synchronized(function() use ($shared) : bool {
+	return $shared->wait(-1);
+}));
+
+try {
+	$shared->waitNs(-1);
+} catch (ValueError $e) {
+	echo $e->getMessage() . PHP_EOL;
+}
+
+$thread = new class($shared) extends Thread {
+	public function __construct(private ThreadedArray $shared) {}
+
+	public function run() : void {
+		$this->shared->synchronized(function() : void {
+			$this->shared["ready"] = true;
+			$this->shared->notify();
+		});
+	}
+};
+
+var_dump($shared->synchronized(function() use ($shared, $thread) : bool {
+	$thread->start();
+	$notified = true;
+	while (!$shared["ready"]) {
+		$notified = $shared->waitNs(10 * 1000000000);
+	}
+	return $notified;
+}));
+$thread->join();
+?>
+--EXPECT--
+array(2) {
+  [0]=>
+  bool(false)
+  [1]=>
+  bool(true)
+}
+bool(false)
+ThreadedBase::waitNs(): Argument #1 ($nanoseconds) must be greater than or equal to 0
+bool(true)
@@ -0,0 +1,79 @@
+--TEST--
+Test waiting for conditions on members
+--DESCRIPTION--
+waitUntil(), waitUntilNotEmpty() and waitUntilCount() wait for a condition on the members of an object, which is
+checked whenever the members change without returning to user code. This test verifies that each returns once its
+condition holds, and false when the timeout is reached first.
+--FILE--
+<?php
+class State extends ThreadedBase {
+	public $stage = "init";
+	public $result = null;
+}
+
+$state = new State;
+$array = new ThreadedArray;
+$queue = new ThreadedQueue;
+
+var_dump($state->waitUntil("stage", "init"));
+var_dump($state->waitUntil("stage", "done", 1000000));
+var_dump($state->waitUntilNotEmpty("result", 1000000));
+var_dump($array->waitUntilCount(1, 1000000));
+var_dump($array->waitUntil("missing", null));
+
+try {
+	$state->waitUntil("stage", "done", -1);
+} catch (ValueError $e) {
+	echo $e->getMessage() . PHP_EOL;
+}
+
+$thread = new class($state, $array, $queue) extends Thread {
+	public function __construct(
+		private State $state,
+		private ThreadedArray $array,
+		private ThreadedQueue $queue
+	) {}
+
+	public function run() : void {
+		//none of these satisfy the waiting thread, which must keep waiting
+		$this->state->stage = "working";
+		$this->state->result = "0";
+		$this->state->result = [];
+
+		$this->state->result = str_repeat("r", 100);
+		$this->state->stage = "done";
+
+		for ($i = 0; $i < 10; $i++) {
+			$this->array[] = $i;
+		}
+		$this->array["key"] = 1.5;
+		for ($i = 0; $i < 3; $i++) {
+			$this->queue->push($i);
+		}
+	}
+};
+$thread->start();
+
+var_dump($state->waitUntil("stage", "done"));
+var_dump($state->waitUntilNotEmpty("result"), strlen($state->result));
+var_dump($array->waitUntilCount(10), $array->waitUntil("key", 1.5), count($array));
+var_dump($queue->waitUntilCount(3), count($queue));
+var_dump($array->waitUntil(0, "0", 1000000));
+$thread->join();
+?>
+--EXPECT--
+bool(true)
+bool(false)
+bool(false)
+bool(false)
+bool(true)
+ThreadedBase::waitUntil(): Argument #3 ($nanoseconds) must be greater than or equal to 0
+bool(true)
+bool(true)
+int(100)
+bool(true)
+bool(true)
+int(11)
+bool(true)
+int(3)
+bool(false)